@@ -0,0 +1,67 @@
+#!/bin/bash
+# Benchmark driver, run by "make bench". Runs main over every combination of graph, rank count and mode, checks every
+# result against the serial union-find of ./reference and appends one row per run to a CSV table.
+#
+# configuration (environment variables):
+#   BENCH_GRAPHS   HDF5 graph files (default: data/coauth-DBLP-full-proj-graph-LIST_REMAP.h5)
+#   BENCH_RANKS    rank counts (default: 1 2 4 8)
+#   BENCH_MODES    argument sets for main, separated by ';' (default: the reductions, edge partitioning, varint and node with 2 ranks per node)
+#   BENCH_ARGS     arguments passed to every run, e.g. --threads=4
+#   BENCH_REPEAT   timed runs per combination, after one warm-up run (default: 3)
+#   BENCH_OUT      the CSV table, rows are appended (default: bench_results.csv)
+#   MPIEXEC        launcher (default: mpiexec --oversubscribe --allow-run-as-root)
+#
+# the exit code is 1 if any run did not match the reference.
+
+GRAPHS=${BENCH_GRAPHS:-data/coauth-DBLP-full-proj-graph-LIST_REMAP.h5}
+RANKS=${BENCH_RANKS:-1 2 4 8}
+MODES=${BENCH_MODES:---reduction=butterfly;--reduction=tree;--reduction=tree --partition=edges;--reduction=tree --wire=varint;--reduction=node --ranks-per-node=2}
+REPEAT=${BENCH_REPEAT:-3}
+OUT=${BENCH_OUT:-bench_results.csv}
+MPIEXEC=${MPIEXEC:-mpiexec --oversubscribe --allow-run-as-root}
+
+VERSION=$(git describe --always --dirty 2>/dev/null || echo unknown)
+DATE=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ ! -s "$OUT" ]; then
+    echo "date,version,graph,ranks,mode,components,reference_components,check,average_seconds,reference_seconds" >"$OUT"
+fi
+
+failures=0
+IFS=';' read -ra mode_list <<<"$MODES"
+for graph in $GRAPHS; do
+    reference_output=$(./reference "$graph") || exit 1
+    reference_components=$(echo "$reference_output" | sed -n 's/^components //p')
+    reference_seconds=$(echo "$reference_output" | sed -n 's/^reference time //p')
+
+    for ranks in $RANKS; do
+        for mode in "${mode_list[@]}"; do
+            # one run that writes the labels for the check, then the timed runs without output
+            rm -f "$WORK/labels.h5"
+            run_output=$($MPIEXEC -n "$ranks" ./main --input="$graph" $mode $BENCH_ARGS --output="$WORK/labels.h5" --component-sizes 2>&1)
+            components=$(echo "$run_output" | sed -n 's/^Number of connected components: //p')
+            if check_output=$(./reference "$graph" "$WORK/labels.h5" 2>&1); then
+                check=ok
+            else
+                check=FAILED
+                failures=$((failures + 1))
+                echo "$graph, $ranks ranks, $mode: $(echo "$check_output" | tail -n 1)" >&2
+                echo "$run_output" | grep -i error >&2
+            fi
+
+            timed_output=$($MPIEXEC -n "$ranks" ./main --input="$graph" $mode $BENCH_ARGS --warmup=1 --repeat="$REPEAT" 2>&1)
+            average_seconds=$(echo "$timed_output" | sed -n 's/.*average time: //p' | tail -n 1)
+
+            row="$DATE,$VERSION,$graph,$ranks,\"$mode\",$components,$reference_components,$check,$average_seconds,$reference_seconds"
+            echo "$row" >>"$OUT"
+            echo "$row"
+        done
+    done
+done
+
+if [ $failures -gt 0 ]; then
+    echo "$failures runs did not match the reference" >&2
+    exit 1
+fi
@@ -0,0 +1,692 @@
+/*
+Streaming converter from an edge file (3 integers per row: source, destination, ignored) to the HDF5 list format read
+by main.cpp. This does the same as convert_to_list_format_remap.py followed by convert_to_hdf5.py, but in bounded memory:
+
+    1. the edge file is streamed into runs of at most --memory bytes. every run holds both directions of each edge, gets
+       sorted and deduplicated (on a second thread, while the next run is being read) and is written to a temporary file.
+    2. the runs are merged once to collect the sorted distinct vertex ids. the remapped id of a vertex is its position in
+       this table, i.e. vertices keep their original order, which is also what the python scripts do.
+    3. the runs are merged a second time and written as "vertex neighbors... -1" lines into the data dataset, together
+       with the (start, end) index pairs of the lookup dataset and the vertices count.
+
+The only structure that grows with the graph is the vertex id table (8 bytes per vertex); edges always stay on disk.
+
+With --format=csr the output is not an HDF5 file but the binary CSR format that main.cpp maps into memory instead of
+reading it: a header page, the offsets and the (remapped) neighbors of all vertices, each array page aligned. ids and
+offsets are 32 bit unless the graph needs 64; --vertex-id-bits / --edge-offset-bits choose the widths of the main build
+the file is meant for (its VERTEX_ID_BITS / EDGE_OFFSET_BITS), since main maps the arrays as they are.
+
+usage: convert <edge file> <output> [--memory=<MiB>] [--tmp=<directory>] [--format=hdf5|csr] [--vertex-id-bits=32|64]
+               [--edge-offset-bits=32|64]
+*/
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <queue>
+#include <thread>
+#include <functional>
+#include <stdexcept>
+#include <cstdint>
+#include <exception>
+#include <unistd.h>
+#include <hdf5.h>
+
+struct Edge
+{
+    long long from;
+    long long to;
+
+    bool operator<(const Edge &other) const
+    {
+        return from < other.from || (from == other.from && to < other.to);
+    }
+    bool operator==(const Edge &other) const
+    {
+        return from == other.from && to == other.to;
+    }
+};
+
+/// @brief buffered reader for whitespace separated integers
+class IntegerReader
+{
+private:
+    FILE *file;
+    std::vector<char> buffer;
+    size_t position;
+    size_t filled;
+
+    int next()
+    {
+        if (position == filled)
+        {
+            filled = fread(buffer.data(), 1, buffer.size(), file);
+            position = 0;
+            if (filled == 0)
+            {
+                return EOF;
+            }
+        }
+        return buffer[position++];
+    }
+
+public:
+    IntegerReader(const std::string &path) : buffer(1 << 20), position(0), filled(0)
+    {
+        file = fopen(path.c_str(), "rb");
+        if (file == NULL)
+        {
+            throw std::runtime_error("Could not open " + path);
+        }
+    }
+
+    ~IntegerReader()
+    {
+        fclose(file);
+    }
+
+    /*returns false at the end of the file*/
+    bool read(long long &value)
+    {
+        int c = next();
+        while (c != EOF && c != '-' && (c < '0' || c > '9'))
+        {
+            c = next();
+        }
+        if (c == EOF)
+        {
+            return false;
+        }
+
+        bool negative = c == '-';
+        if (negative)
+        {
+            c = next();
+        }
+        value = 0;
+        while (c >= '0' && c <= '9')
+        {
+            value = value * 10 + (c - '0');
+            c = next();
+        }
+        if (negative)
+        {
+            value = -value;
+        }
+        return true;
+    }
+};
+
+/// @brief sequential reader over a run file of sorted edges
+class RunReader
+{
+private:
+    FILE *file;
+    std::vector<Edge> buffer;
+    size_t position;
+    size_t filled;
+
+public:
+    RunReader(const std::string &path, size_t bufferEdges) : buffer(bufferEdges), position(0), filled(0)
+    {
+        file = fopen(path.c_str(), "rb");
+        if (file == NULL)
+        {
+            throw std::runtime_error("Could not open run file " + path);
+        }
+    }
+
+    ~RunReader()
+    {
+        fclose(file);
+    }
+
+    RunReader(const RunReader &) = delete;
+    RunReader &operator=(const RunReader &) = delete;
+
+    bool next(Edge &edge)
+    {
+        if (position == filled)
+        {
+            filled = fread(buffer.data(), sizeof(Edge), buffer.size(), file);
+            position = 0;
+            if (filled == 0)
+            {
+                return false;
+            }
+        }
+        edge = buffer[position++];
+        return true;
+    }
+};
+
+/// @brief external sort of the symmetric edge set
+class ExternalEdgeSorter
+{
+private:
+    std::string runDirectory;
+    size_t runEdges;
+    std::vector<std::string> runFiles;
+    std::exception_ptr writeError;
+
+    void writeRun(std::vector<Edge> &run, const std::string &path)
+    {
+        std::sort(run.begin(), run.end());
+        run.erase(std::unique(run.begin(), run.end()), run.end());
+
+        FILE *file = fopen(path.c_str(), "wb");
+        if (file == NULL)
+        {
+            throw std::runtime_error("Could not create run file " + path);
+        }
+        bool written = fwrite(run.data(), sizeof(Edge), run.size(), file) == run.size();
+        if (fclose(file) != 0 || !written)
+        {
+            throw std::runtime_error("Could not write run file " + path);
+        }
+        run.clear();
+    }
+
+    /*runs writeRun on the writer thread. an exception must not leave the thread, it is kept for joinWriter*/
+    void writeRunCaught(std::vector<Edge> &run, const std::string &path)
+    {
+        try
+        {
+            writeRun(run, path);
+        }
+        catch (...)
+        {
+            writeError = std::current_exception();
+        }
+    }
+
+    void joinWriter(std::thread &writer)
+    {
+        if (writer.joinable())
+        {
+            writer.join();
+        }
+        if (writeError)
+        {
+            std::exception_ptr error = writeError;
+            writeError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+public:
+    /*the runs go to a fresh directory below tmpDirectory, so concurrent conversions never share run files*/
+    ExternalEdgeSorter(const std::string &tmpDirectory, size_t memoryBytes)
+        : runEdges(std::max<size_t>(memoryBytes / 2 / sizeof(Edge), 1024))
+    {
+        std::string pattern = tmpDirectory + "/convert_XXXXXX";
+        std::vector<char> path(pattern.begin(), pattern.end());
+        path.push_back('\0');
+        if (mkdtemp(path.data()) == NULL)
+        {
+            throw std::runtime_error("Could not create a temporary directory in " + tmpDirectory);
+        }
+        runDirectory = path.data();
+    }
+
+    ~ExternalEdgeSorter()
+    {
+        for (const std::string &path : runFiles)
+        {
+            std::remove(path.c_str());
+        }
+        rmdir(runDirectory.c_str());
+    }
+
+    /*reads the edge file and writes sorted, deduplicated runs. one run is sorted while the next one is filled*/
+    long long createRuns(const std::string &edgeFile)
+    {
+        IntegerReader reader(edgeFile);
+        std::vector<Edge> filling;
+        std::vector<Edge> sorting;
+        filling.reserve(runEdges);
+        std::thread writer;
+        long long edges = 0;
+
+        // a thread that is still joinable when it is destroyed calls terminate, so join it on every way out
+        struct WriterGuard
+        {
+            std::thread &writer;
+            ~WriterGuard()
+            {
+                if (writer.joinable())
+                {
+                    writer.join();
+                }
+            }
+        } guard{writer};
+
+        long long from, to, ignored;
+        bool more = true;
+        while (more)
+        {
+            more = reader.read(from) && reader.read(to) && reader.read(ignored);
+            if (more)
+            {
+                filling.push_back(Edge{from, to});
+                filling.push_back(Edge{to, from});
+                edges++;
+            }
+
+            if (filling.size() + 2 > runEdges || (!more && !filling.empty()))
+            {
+                joinWriter(writer);
+                std::swap(filling, sorting);
+                filling.reserve(runEdges);
+                runFiles.push_back(runDirectory + "/run_" + std::to_string(runFiles.size()) + ".bin");
+                writer = std::thread(&ExternalEdgeSorter::writeRunCaught, this, std::ref(sorting), runFiles.back());
+            }
+        }
+        joinWriter(writer);
+        return edges;
+    }
+
+    /*calls consume(edge) for every distinct edge in sorted order*/
+    template <typename Consumer>
+    void merge(Consumer consume)
+    {
+        typedef std::pair<Edge, size_t> Entry;
+        auto greater = [](const Entry &a, const Entry &b)
+        { return b.first < a.first; };
+        std::priority_queue<Entry, std::vector<Entry>, decltype(greater)> heap(greater);
+
+        std::vector<RunReader *> readers;
+        size_t bufferEdges = std::max<size_t>(runEdges / std::max<size_t>(runFiles.size(), 1), 1024);
+        for (size_t i = 0; i < runFiles.size(); ++i)
+        {
+            readers.push_back(new RunReader(runFiles[i], bufferEdges));
+            Edge edge;
+            if (readers[i]->next(edge))
+            {
+                heap.push(Entry(edge, i));
+            }
+        }
+
+        bool first = true;
+        Edge previous = {0, 0};
+        while (!heap.empty())
+        {
+            Entry entry = heap.top();
+            heap.pop();
+
+            // runs are deduplicated on their own, duplicates across runs arrive next to each other
+            if (first || !(entry.first == previous))
+            {
+                consume(entry.first);
+                previous = entry.first;
+                first = false;
+            }
+
+            Edge edge;
+            if (readers[entry.second]->next(edge))
+            {
+                heap.push(Entry(edge, entry.second));
+            }
+        }
+
+        for (RunReader *reader : readers)
+        {
+            delete reader;
+        }
+    }
+};
+
+/// @brief writes the data/lookup/vertices datasets in blocks
+class HDF5ListWriter
+{
+private:
+    hid_t file;
+    hid_t data;
+    hid_t lookup;
+    std::vector<long long> dataBlock;
+    std::vector<long long> lookupBlock;
+    hsize_t dataWritten;
+    hsize_t lookupWritten;
+    size_t blockSize;
+
+    static void check(long long status, const std::string &what)
+    {
+        if (status < 0)
+        {
+            throw std::runtime_error("HDF5 error: " + what);
+        }
+    }
+
+    /*int32 if every value fits, int64 otherwise (main.cpp then needs to be built with VERTEX_ID_BITS/EDGE_OFFSET_BITS=64)*/
+    static hid_t createDataset(hid_t file, const char *name, int rank, const hsize_t *dims, long long maxValue)
+    {
+        hid_t type = maxValue > INT_MAX ? H5T_STD_I64LE : H5T_STD_I32LE;
+        hid_t space = H5Screate_simple(rank, dims, NULL);
+        hid_t dataset = H5Dcreate(file, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        H5Sclose(space);
+        check(dataset, std::string("could not create dataset ") + name);
+        return dataset;
+    }
+
+    static void writeBlock(hid_t dataset, int rank, hsize_t firstRow, std::vector<long long> &block)
+    {
+        if (block.empty())
+        {
+            return;
+        }
+        hsize_t count[2] = {block.size() / rank, 2};
+        hsize_t offset[2] = {firstRow, 0};
+        hid_t memspace = H5Screate_simple(rank, count, NULL);
+        hid_t filespace = H5Dget_space(dataset);
+        H5Sselect_hyperslab(filespace, H5S_SELECT_SET, offset, NULL, count, NULL);
+        herr_t status = H5Dwrite(dataset, H5T_NATIVE_LLONG, memspace, filespace, H5P_DEFAULT, block.data());
+        H5Sclose(filespace);
+        H5Sclose(memspace);
+        check(status, "could not write block");
+        block.clear();
+    }
+
+    void flushData()
+    {
+        hsize_t rows = dataBlock.size();
+        writeBlock(data, 1, dataWritten, dataBlock);
+        dataWritten += rows;
+    }
+
+    void flushLookup()
+    {
+        hsize_t rows = lookupBlock.size() / 2;
+        writeBlock(lookup, 2, lookupWritten, lookupBlock);
+        lookupWritten += rows;
+    }
+
+public:
+    HDF5ListWriter(const std::string &path, long long vertices, long long entries, size_t blockSize)
+        : dataWritten(0), lookupWritten(0), blockSize(blockSize)
+    {
+        file = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+        check(file, "could not create " + path);
+
+        hsize_t dataDims[1] = {static_cast<hsize_t>(entries)};
+        hsize_t lookupDims[2] = {static_cast<hsize_t>(vertices), 2};
+        data = createDataset(file, "data", 1, dataDims, vertices);
+        lookup = createDataset(file, "lookup", 2, lookupDims, entries);
+
+        hid_t scalar = H5Screate(H5S_SCALAR);
+        hid_t verticesDataset = H5Dcreate(file, "vertices", H5T_STD_I64LE, scalar, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        check(H5Dwrite(verticesDataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, &vertices), "could not write vertices");
+        H5Dclose(verticesDataset);
+        H5Sclose(scalar);
+    }
+
+    ~HDF5ListWriter()
+    {
+        H5Dclose(lookup);
+        H5Dclose(data);
+        H5Fclose(file);
+    }
+
+    HDF5ListWriter(const HDF5ListWriter &) = delete;
+    HDF5ListWriter &operator=(const HDF5ListWriter &) = delete;
+
+    void beginLine(long long vertex)
+    {
+        lookupBlock.push_back(dataWritten + dataBlock.size());
+        push(vertex);
+    }
+
+    void push(long long value)
+    {
+        dataBlock.push_back(value);
+        if (dataBlock.size() >= blockSize)
+        {
+            flushData();
+        }
+    }
+
+    void endLine()
+    {
+        lookupBlock.push_back(dataWritten + dataBlock.size());
+        push(-1);
+        if (lookupBlock.size() >= blockSize)
+        {
+            flushLookup();
+        }
+    }
+
+    void finish()
+    {
+        flushData();
+        flushLookup();
+    }
+};
+
+/*
+writes the binary CSR format that main.cpp maps into memory (MappedGraph): a header page, the vertices + 1 offsets
+into targets and the targets, both arrays starting on a page boundary. ids and offsets are int32 if they fit, int64
+otherwise. offsets and targets are written sequentially through two handles of the same file.
+*/
+class CSRWriter
+{
+private:
+    static const long long PAGE = 4096;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t vertex_id_bytes;
+        uint32_t edge_offset_bytes;
+        uint64_t vertices;
+        uint64_t edges;
+        uint64_t offsets_position;
+        uint64_t targets_position;
+    };
+
+    FILE *offsetFile;
+    FILE *targetFile;
+    Header header;
+    long long targetsWritten;
+
+    static void writeValue(FILE *file, long long value, uint32_t bytes)
+    {
+        size_t written;
+        if (bytes == 4)
+        {
+            int32_t narrow = static_cast<int32_t>(value);
+            written = fwrite(&narrow, sizeof(narrow), 1, file);
+        }
+        else
+        {
+            int64_t wide = value;
+            written = fwrite(&wide, sizeof(wide), 1, file);
+        }
+        if (written != 1)
+        {
+            throw std::runtime_error("Could not write the CSR file");
+        }
+    }
+
+public:
+    /*the widths are the narrowest that fit, at least vertexIdBits / edgeOffsetBits (0: no minimum)*/
+    CSRWriter(const std::string &path, long long vertices, long long edges, int vertexIdBits, int edgeOffsetBits) : targetsWritten(0)
+    {
+        header = Header();
+        std::string magic = "CCCSR1";
+        std::copy(magic.begin(), magic.end(), header.magic);
+        header.vertex_id_bytes = vertices > INT_MAX || vertexIdBits == 64 ? 8 : 4;
+        header.edge_offset_bytes = edges > INT_MAX || edgeOffsetBits == 64 ? 8 : 4;
+        if ((vertexIdBits == 32 && header.vertex_id_bytes == 8) || (edgeOffsetBits == 32 && header.edge_offset_bytes == 8))
+        {
+            throw std::runtime_error("The graph needs 64 bit ids or offsets, it does not fit the requested 32 bits");
+        }
+        header.vertices = vertices;
+        header.edges = edges;
+        header.offsets_position = PAGE;
+        long long offsetsEnd = PAGE + (vertices + 1) * header.edge_offset_bytes;
+        header.targets_position = (offsetsEnd + PAGE - 1) / PAGE * PAGE;
+
+        offsetFile = fopen(path.c_str(), "wb+");
+        if (offsetFile == NULL)
+        {
+            throw std::runtime_error("Could not create " + path);
+        }
+        if (fwrite(&header, sizeof(header), 1, offsetFile) != 1 || fflush(offsetFile) != 0)
+        {
+            fclose(offsetFile);
+            throw std::runtime_error("Could not write the header of " + path);
+        }
+        targetFile = fopen(path.c_str(), "rb+");
+        if (targetFile == NULL)
+        {
+            fclose(offsetFile);
+            throw std::runtime_error("Could not open " + path);
+        }
+        if (fseek(offsetFile, header.offsets_position, SEEK_SET) != 0 || fseek(targetFile, header.targets_position, SEEK_SET) != 0)
+        {
+            fclose(targetFile);
+            fclose(offsetFile);
+            throw std::runtime_error("Could not seek in " + path);
+        }
+    }
+
+    ~CSRWriter()
+    {
+        fclose(targetFile);
+        fclose(offsetFile);
+    }
+
+    CSRWriter(const CSRWriter &) = delete;
+    CSRWriter &operator=(const CSRWriter &) = delete;
+
+    void beginLine(long long vertex)
+    {
+        writeValue(offsetFile, targetsWritten, header.edge_offset_bytes);
+    }
+
+    void push(long long value)
+    {
+        writeValue(targetFile, value, header.vertex_id_bytes);
+        targetsWritten++;
+    }
+
+    void endLine()
+    {
+    }
+
+    void finish()
+    {
+        writeValue(offsetFile, targetsWritten, header.edge_offset_bytes);
+        if (fflush(offsetFile) != 0 || fflush(targetFile) != 0)
+        {
+            throw std::runtime_error("Could not write the CSR file");
+        }
+    }
+};
+
+/*pass 2: remaps the sorted edges and writes them line by line, in the HDF5 list or the CSR format*/
+template <typename Writer>
+void writeLines(ExternalEdgeSorter &sorter, const std::vector<long long> &ids, Writer &writer)
+{
+    // sources arrive in the order of the id table, so their remapped id is a running counter
+    long long from = -1;
+    sorter.merge([&](const Edge &edge)
+                 {
+                     if (from == -1 || ids[from] != edge.from)
+                     {
+                         if (from != -1)
+                         {
+                             writer.endLine();
+                         }
+                         writer.beginLine(++from);
+                     }
+                     writer.push(std::lower_bound(ids.begin(), ids.end(), edge.to) - ids.begin());
+                 });
+    if (from != -1)
+    {
+        writer.endLine();
+    }
+    writer.finish();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <edge file> <output> [--memory=<MiB>] [--tmp=<directory>] [--format=hdf5|csr] [--vertex-id-bits=32|64] [--edge-offset-bits=32|64]" << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argv[2];
+    size_t memoryBytes = size_t(1024) << 20;
+    std::string tmpDirectory = ".";
+    bool csr = false;
+    int vertexIdBits = 0;
+    int edgeOffsetBits = 0;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--memory=") == 0)
+        {
+            memoryBytes = std::stoull(arg.substr(9)) << 20;
+        }
+        else if (arg.compare(0, 6, "--tmp=") == 0)
+        {
+            tmpDirectory = arg.substr(6);
+        }
+        else if (arg == "--format=hdf5" || arg == "--format=csr")
+        {
+            csr = arg == "--format=csr";
+        }
+        else if (arg == "--vertex-id-bits=32" || arg == "--vertex-id-bits=64")
+        {
+            vertexIdBits = std::stoi(arg.substr(17));
+        }
+        else if (arg == "--edge-offset-bits=32" || arg == "--edge-offset-bits=64")
+        {
+            edgeOffsetBits = std::stoi(arg.substr(19));
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    ExternalEdgeSorter sorter(tmpDirectory, memoryBytes);
+    long long edges = sorter.createRuns(input);
+
+    // pass 1: distinct vertex ids (every vertex with an edge shows up as a source) and amount of neighbor entries
+    std::vector<long long> ids;
+    long long neighborEntries = 0;
+    sorter.merge([&](const Edge &edge)
+                 {
+                     if (ids.empty() || ids.back() != edge.from)
+                     {
+                         ids.push_back(edge.from);
+                     }
+                     neighborEntries++;
+                 });
+
+    long long vertices = ids.size();
+    long long entries = neighborEntries + 2 * vertices; // every line also holds its vertex id and the -1 separator
+    std::cout << "edges: " << edges << ", vertices: " << vertices << ", distinct directed edges: " << neighborEntries << std::endl;
+
+    // pass 2: remap and write the lines
+    if (csr)
+    {
+        CSRWriter writer(output, vertices, neighborEntries, vertexIdBits, edgeOffsetBits);
+        writeLines(sorter, ids, writer);
+    }
+    else
+    {
+        HDF5ListWriter writer(output, vertices, entries, std::max<size_t>(memoryBytes / 2 / sizeof(long long), 1024));
+        writeLines(sorter, ids, writer);
+    }
+
+    std::cout << "written " << output << std::endl;
+    return 0;
+}
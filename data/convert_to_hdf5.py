@@ -14,9 +14,11 @@ def create_hdf5_with_lookup(input_file, output_file):
             lookup.append((current_index, current_index + len(numbers)))
             current_index += len(numbers) + 1
 
-    # Convert to numpy arrays
-    data_array = np.array(data, dtype='int32')
-    lookup_array = np.array(lookup, dtype='int32')
+    # Convert to numpy arrays, int64 only where int32 would overflow
+    # (the C++ program then needs to be built with VERTEX_ID_BITS=64 / EDGE_OFFSET_BITS=64)
+    int32_max = np.iinfo('int32').max
+    data_array = np.array(data, dtype='int32' if len(lookup) <= int32_max else 'int64')
+    lookup_array = np.array(lookup, dtype='int32' if current_index <= int32_max else 'int64')
 
     # Create HDF5 file
     with h5py.File(output_file, 'w') as h5file:
@@ -7,879 +7,1376 @@
 #include <cassert>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <random>
-#include <H5Cpp.h>
+#include <hdf5.h>
 #include <stack>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+#include <memory>
+#include <cstring>
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 
 #define DEBUG_CONDITION false
 #define RANK_OF_INTEREST 0
 #define COUNT_CC true
+#define PRINT_PARTITION true
+#define PRINT_READ_BANDWIDTH true
+#define PRINT_CAG_LEVELS true
 
-/// @brief
+enum PartitionMode
+{
+    PARTITION_VERTICES, // equal amount of vertices per rank
+    PARTITION_EDGES     // contiguous ranges with roughly equal amount of edges per rank
+};
 
-class CAG
+enum ReductionMode
 {
-public:
-    struct Node
-    {
-        int id;
-        bool isForeign;
-        std::unordered_set<int> neighbors; // Using unordered_set to avoid duplicates
-        bool is_next_to_foreign;
-        Node() : id(-1), isForeign(false), is_next_to_foreign(false) {} // Default constructor
-        Node(int _id, bool _isForeign) : id(_id), isForeign(_isForeign), is_next_to_foreign(false) {}
-    };
+    REDUCTION_BUTTERFLY, // recursive doubling, both partners of a level merge and end up with the whole graph's CAG
+    REDUCTION_TREE,      // binomial tree up to rank 0, then the resolved labels are sent back down
+    REDUCTION_NODE       // the ranks of a node merge into its first rank through shared memory, then REDUCTION_TREE over these
+};
+
+enum StatsFormat
+{
+    STATS_NONE,
+    STATS_JSON,
+    STATS_CSV
+};
+
+enum WireFormat
+{
+    WIRE_RAW,   // CAG::serialize(), one VertexId per id, flag and count
+    WIRE_VARINT // CAG::encode(), zigzag deltas as LEB128 varints
+};
+
+enum GraphGenerator
+{
+    GENERATE_NONE,   // read the graph from the HDF5 file
+    GENERATE_ER,     // Erdos-Renyi, edge_factor * 2^scale uniformly random edges
+    GENERATE_RMAT,   // R-MAT with the Graph500 parameters, edge_factor * 2^scale edges
+    GENERATE_GRID,   // 2D grid of 2^(scale / 2) rows
+    GENERATE_PATH,   // a single path through all 2^scale vertices
+    GENERATE_LADDER  // two paths of 2^(scale - 1) vertices, joined by a rung at every step
+};
+
+/// @brief runtime options, set from the command line in main()
+struct Config
+{
+    PartitionMode partition_mode = PARTITION_VERTICES;
+    // with PARTITION_EDGES, every expected border edge counts as 1 + border_weight edges
+    double border_weight = 0.0;
+    ReductionMode reduction_mode = REDUCTION_BUTTERFLY;
+    WireFormat wire_format = WIRE_RAW;
+    // with REDUCTION_NODE, nodes are emulated by groups of this many consecutive ranks, 0 uses the real nodes
+    int ranks_per_node = 0;
+    // the CAG exchange is split into messages of about this many (raw) bytes, 0 sends it in one message
+    size_t chunk_bytes = 1 << 20;
+    // threads per rank for the local connected components
+    int threads = 1;
+    // the graph file, HDF5 or the CSR format of MappedGraph
+    std::string input_path = "data/coauth-DBLP-full-proj-graph-LIST_REMAP.h5";
+    // if set, the labels are written to this HDF5 file
+    std::string output_path;
+    // with output_path, also write the size of every component
+    bool component_sizes = false;
+    // run() is called warmup + repeat times, only the last repeat runs are timed and reported
+    int warmup = 0;
+    int repeat = 1;
+    // the per-phase profile of the timed runs, written by rank 0 to stats_path (standard output if empty)
+    StatsFormat stats_format = STATS_NONE;
+    std::string stats_path;
+    // if set, every rank generates its part of a synthetic graph with 2^scale vertices instead of reading the file
+    GraphGenerator generator = GENERATE_NONE;
+    int scale = 20;
+    int edge_factor = 16;
+    unsigned long long seed = 1;
+    // permute the vertex ids of the generated graph (always done for R-MAT)
+    bool scramble = false;
+    // edge files that are added one after the other to the components of the run, see applyEdgeBatch()
+    std::vector<std::string> batch_paths;
+    // if set, the components are read from the labels of this earlier output file instead of computed, see runFromLabels()
+    std::string labels_path;
+};
+
+// Vertex ids / labels and edge offsets are template parameters, so graphs with more than 2^31 vertices or
+// adjacency entries can be handled by a 64 bit build while the default build keeps its 32 bit footprint.
+#ifndef VERTEX_ID_BITS
+#define VERTEX_ID_BITS 32
+#endif
+#ifndef EDGE_OFFSET_BITS
+#define EDGE_OFFSET_BITS 32
+#endif
+
+#if VERTEX_ID_BITS == 64
+typedef long long GraphVertexId;
+#else
+typedef int GraphVertexId;
+#endif
+#if EDGE_OFFSET_BITS == 64
+typedef long long GraphEdgeOffset;
+#else
+typedef int GraphEdgeOffset;
+#endif
+
+template <typename T>
+struct MPIType;
+template <>
+struct MPIType<int>
+{
+    static MPI_Datatype get() { return MPI_INT; }
+};
+template <>
+struct MPIType<long long>
+{
+    static MPI_Datatype get() { return MPI_LONG_LONG; }
+};
 
-    std::unordered_map<int, Node> nodes;
-    std::unordered_map<int, int> union_find;
-    std::unordered_set<int> values_in_union_find;
-    int local_information_id_min;
-    int local_information_id_max;
+template <typename T>
+struct HDF5Type;
+template <>
+struct HDF5Type<int>
+{
+    static hid_t get() { return H5T_NATIVE_INT; }
+};
+template <>
+struct HDF5Type<long long>
+{
+    static hid_t get() { return H5T_NATIVE_LLONG; }
+};
 
-    // Method to serialize the nodes into a vector
-    std::vector<int> serialize() const
+/*runs body(begin, end, thread) on threads std::threads, each on one contiguous block of [0, count)*/
+template <typename Body>
+void parallelBlocks(int threads, size_t count, const Body &body)
+{
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back(body, count * t / threads, count * (t + 1) / threads, t);
+    }
+    for (std::thread &worker : workers)
     {
-        std::vector<int> data;
+        worker.join();
+    }
+}
 
-        data.push_back(local_information_id_min);
-        data.push_back(local_information_id_max);
+/// @brief read-only view of a contiguous run of ids, e.g. the neighbors of one vertex
+template <typename T>
+struct IdRange
+{
+    const T *first;
+    const T *last;
+    const T *begin() const { return first; }
+    const T *end() const { return last; }
+    const T *data() const { return first; }
+    size_t size() const { return last - first; }
+};
 
-        // Serialize each node
-        for (const auto &nodePair : nodes)
-        {
-            const Node &node = nodePair.second;
+/// @brief open addressing (linear probing) index from ids to slots. ids have to be non-negative, there is no deletion.
+template <typename VertexId>
+class FlatIndex
+{
+private:
+    static const VertexId EMPTY = -1;
+    std::vector<VertexId> keys;
+    std::vector<uint32_t> values;
+    size_t count;
+    size_t mask;
+
+    size_t bucket(VertexId key) const
+    {
+        uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+        return (h ^ (h >> 32)) & mask;
+    }
 
-            // Serialize node ID
-            data.push_back(node.id);
+public:
+    static const uint32_t NOT_FOUND = UINT32_MAX;
 
-            // Serialize isForeign (as 0 or 1)
-            data.push_back(node.isForeign ? 1 : 0);
+    FlatIndex() { clear(0); }
 
-            // Serialize the number of neighbors
-            data.push_back(node.neighbors.size());
+    /*removes all entries and makes room for expected entries without growing*/
+    void clear(size_t expected)
+    {
+        size_t capacity = 16;
+        while (capacity < expected * 2)
+        {
+            capacity *= 2;
+        }
+        VertexId empty = EMPTY;
+        keys.assign(capacity, empty);
+        values.resize(capacity);
+        count = 0;
+        mask = capacity - 1;
+    }
 
-            // Serialize each neighbor
-            for (int neighborId : node.neighbors)
+    uint32_t find(VertexId key) const
+    {
+        for (size_t b = bucket(key);; b = (b + 1) & mask)
+        {
+            if (keys[b] == key)
             {
-                data.push_back(neighborId);
+                return values[b];
+            }
+            if (keys[b] == EMPTY)
+            {
+                return NOT_FOUND;
             }
         }
+    }
 
-        // Add a special marker at the end (e.g., -1) to indicate the end of data
-        data.push_back(-1);
+    /*inserts key or overwrites its value*/
+    void insert(VertexId key, uint32_t value)
+    {
+        if ((count + 1) * 2 > keys.size())
+        {
+            std::vector<VertexId> old_keys;
+            std::vector<uint32_t> old_values;
+            old_keys.swap(keys);
+            old_values.swap(values);
+            clear(old_keys.size());
+            for (size_t b = 0; b < old_keys.size(); ++b)
+            {
+                if (old_keys[b] != EMPTY)
+                {
+                    insert(old_keys[b], old_values[b]);
+                }
+            }
+        }
 
-        return data;
+        size_t b = bucket(key);
+        while (keys[b] != EMPTY && keys[b] != key)
+        {
+            b = (b + 1) & mask;
+        }
+        if (keys[b] == EMPTY)
+        {
+            keys[b] = key;
+            count++;
+        }
+        values[b] = value;
     }
 
-    void deserialize(const std::vector<int> &data)
+    size_t memoryBytes() const
     {
-        // Clear existing data
-        nodes.clear();
-
-        size_t i = 0;
-        local_information_id_min = data[i++];
-        local_information_id_max = data[i++];
+        return keys.capacity() * sizeof(VertexId) + values.capacity() * sizeof(uint32_t);
+    }
+};
 
-        std::vector<int> temp;
+/*
+LEB128 varints: 7 bits per byte, the high bit is set on all but the last byte. signed values are zigzag encoded first
+(0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) so small deltas of either sign take a single byte.
+*/
+template <typename Bytes>
+inline void appendVarint(Bytes &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
 
-        while (i < data.size() && data[i] != -1)
+inline uint64_t readVarint(const uint8_t *&in)
+{
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (byte < 0x80)
         {
-            // Deserialize node ID
-            int nodeId = data[i++];
+            return value;
+        }
+    }
+}
 
-            // Deserialize isForeign
-            bool isForeign = data[i++] == 1;
+inline uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
 
-            // Deserialize the number of neighbors
-            int numNeighbors = data[i++];
+inline int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
 
-            // Add node
-            addNode(nodeId, isForeign);
+/// @brief one node of a CAG as it is read from a wire buffer
+template <typename VertexId>
+struct NodeRecord
+{
+    VertexId id;
+    bool isForeign;
+    IdRange<VertexId> neighbors;
+};
 
-            // Deserialize and add each neighbor
-            for (int j = 0; j < numNeighbors; ++j)
-            {
-                int neighborId = data[i++];
-                temp.push_back(nodeId);
-                temp.push_back(neighborId);
-            }
-        }
+/// @brief walks the node records of a CAG::serialize() buffer in place, the neighbors point into the buffer
+template <typename VertexId>
+class SerializedRecords
+{
+private:
+    const VertexId *in;
+    const VertexId *end;
+
+public:
+    VertexId id_min;
+    VertexId id_max;
 
-        for (size_t i = 0; i < temp.size(); i += 2)
+    SerializedRecords(const VertexId *data, size_t size) : in(data + 2), end(data + size), id_min(data[0]), id_max(data[1]) {}
+
+    /*reads the next record, false at the end marker*/
+    bool next(NodeRecord<VertexId> &record)
+    {
+        if (in >= end || *in == -1)
         {
-            addEdge(temp[i], temp[i + 1]);
+            return false;
         }
+        record.id = in[0];
+        record.isForeign = in[1] == 1;
+        size_t count = in[2];
+        record.neighbors = IdRange<VertexId>{in + 3, in + 3 + count};
+        in += 3 + count;
+        return true;
     }
+};
 
-    // Add a new node to the graph
-    void addNode(int id)
+/// @brief walks the node records of a CAG::encode() buffer, the neighbors of a record are decoded into a reused vector
+template <typename VertexId>
+class EncodedRecords
+{
+private:
+    const uint8_t *in;
+    size_t remaining;
+    int64_t previous_id;
+    std::vector<VertexId> neighbors;
+
+public:
+    VertexId id_min;
+    VertexId id_max;
+
+    EncodedRecords(const uint8_t *data) : in(data)
     {
-        if (nodes.find(id) == nodes.end())
-        {
-            nodes[id] = Node{id, false};
-        }
+        id_min = unzigzag(readVarint(in));
+        id_max = id_min + unzigzag(readVarint(in));
+        remaining = readVarint(in);
+        previous_id = id_min;
     }
 
-    void addNode(int id, bool isForeign)
+    /*reads the next record, its neighbors stay valid until the next call*/
+    bool next(NodeRecord<VertexId> &record)
     {
-        if (nodes.find(id) == nodes.end())
+        if (remaining == 0)
         {
-            nodes[id] = Node{id, isForeign};
+            return false;
         }
-        else
+        remaining--;
+        record.id = previous_id + unzigzag(readVarint(in));
+        previous_id = record.id;
+        uint64_t count_and_flag = readVarint(in);
+        record.isForeign = (count_and_flag & 1) == 1;
+
+        neighbors.resize(count_and_flag / 2);
+        int64_t previous_neighbor = record.id;
+        for (VertexId &neighbor : neighbors)
         {
-            if (nodes[id].isForeign != isForeign)
-            {
-                throw std::runtime_error("Node already exists with different isForeign value.");
-            }
+            previous_neighbor += unzigzag(readVarint(in));
+            neighbor = previous_neighbor;
         }
+        record.neighbors = IdRange<VertexId>{neighbors.data(), neighbors.data() + neighbors.size()};
+        return true;
+    }
+};
+
+/// @brief bytes a rank put on the wire during one CAG exchange, as serialize() would have sent them and as actually sent
+struct WireBytes
+{
+    size_t raw = 0;
+    size_t encoded = 0;
+};
+
+/*
+std::allocator that counts its allocations, used by the buffers a CAG refills on every level: the scratch space of
+compact(), the pending edges and the chunk buffers of the exchange. the instrumentation shows how often a level of the
+reduction tree goes to the heap for them; the node table, the CSR arrays and the index are not counted. the counter is
+shared by all element types, these buffers are only used by the thread that runs the reduction.
+*/
+template <typename T>
+struct CountingAllocator
+{
+    typedef T value_type;
+
+    static unsigned long long &count()
+    {
+        static unsigned long long allocations = 0;
+        return allocations;
     }
 
-    // Add an edge between two nodes
-    void addEdge(int from, int to)
+    CountingAllocator() {}
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U> &) {}
+
+    T *allocate(size_t n)
     {
-        // Check if 'from' node exists, if not, add it
-        if (nodes.find(from) == nodes.end())
+        CountingAllocator<char>::count()++;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *pointer, size_t n)
+    {
+        std::allocator<T>().deallocate(pointer, n);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T> &, const CountingAllocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T> &, const CountingAllocator<U> &)
+{
+    return false;
+}
+
+template <typename T>
+using ScratchVector = std::vector<T, CountingAllocator<T>>;
+
+/*allocations of the ScratchVector buffers so far*/
+inline unsigned long long scratchAllocations()
+{
+    return CountingAllocator<char>::count();
+}
+
+/*
+disjoint sets over vertex ids / labels with path halving and union by size. the ids of the dense range [base, base + count)
+(the labels of this rank) live in plain arrays, every other id (labels of other ranks that got merged into this rank's
+CAG) is appended on first use and found through a FlatIndex. find() returns the label stored at the root of a set, which
+unite() sets explicitly, so the representative label does not depend on the shape of the tree.
+*/
+template <typename VertexId>
+class DisjointSets
+{
+private:
+    VertexId base;
+    size_t dense_count;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> set_size;
+    std::vector<VertexId> label; // only valid at roots
+    FlatIndex<VertexId> overlay;
+
+    uint32_t indexOf(VertexId id) const
+    {
+        if (id >= base && static_cast<size_t>(id - base) < dense_count)
         {
-            addNode(from);
+            return id - base;
         }
+        return overlay.find(id);
+    }
 
-        // Check if 'to' node exists, if not, add it
-        if (nodes.find(to) == nodes.end())
+    uint32_t indexOrAdd(VertexId id)
+    {
+        uint32_t index = indexOf(id);
+        if (index == FlatIndex<VertexId>::NOT_FOUND)
         {
-            addNode(to);
+            index = parent.size();
+            parent.push_back(index);
+            set_size.push_back(1);
+            label.push_back(id);
+            overlay.insert(id, index);
         }
+        return index;
+    }
 
-        // Now add the edge since both nodes exist
-        nodes[from].neighbors.insert(to);
-        nodes[to].neighbors.insert(from);
+    uint32_t root(uint32_t index)
+    {
+        while (parent[index] != index)
+        {
+            parent[index] = parent[parent[index]]; // path halving
+            index = parent[index];
+        }
+        return index;
     }
 
-    void addEdgeLocalToForeign(int from, int to)
+public:
+    DisjointSets() : base(0), dense_count(0) {}
+
+    /*every id of [base, base + count) starts as its own set*/
+    void reset(VertexId base, size_t count)
     {
-        // Check if 'from' node exists, if not, add it
-        if (nodes.find(from) == nodes.end())
+        this->base = base;
+        dense_count = count;
+        parent.resize(count);
+        set_size.assign(count, 1);
+        label.resize(count);
+        for (size_t i = 0; i < count; ++i)
         {
-            addNode(from);
+            parent[i] = i;
+            label[i] = base + i;
         }
+        overlay.clear(0);
+    }
 
-        // Check if 'to' node exists, if not, add it
-        if (nodes.find(to) == nodes.end())
+    /*ids that were never added are their own set*/
+    VertexId find(VertexId id)
+    {
+        uint32_t index = indexOf(id);
+        if (index == FlatIndex<VertexId>::NOT_FOUND)
         {
-            addNode(to, true);
+            return id;
         }
-        else
+        return label[root(index)];
+    }
+
+    bool contains(VertexId id) const
+    {
+        return indexOf(id) != FlatIndex<VertexId>::NOT_FOUND;
+    }
+
+    /*joins the sets of a and b, find() returns representative for all of them afterwards*/
+    void unite(VertexId a, VertexId b, VertexId representative)
+    {
+        uint32_t root_a = root(indexOrAdd(a));
+        uint32_t root_b = root(indexOrAdd(b));
+        if (root_a != root_b)
         {
-            if (!nodes[to].isForeign)
+            if (set_size[root_a] < set_size[root_b])
             {
-                throw std::runtime_error("Node already exists with different isForeign value..");
+                std::swap(root_a, root_b);
             }
+            parent[root_b] = root_a;
+            set_size[root_a] += set_size[root_b];
         }
+        label[root_a] = representative;
+    }
 
-        // Now add the edge since both nodes exist
-        nodes[from].neighbors.insert(to);
-        nodes[to].neighbors.insert(from);
+    /*amount of ids with an entry*/
+    size_t size() const
+    {
+        return parent.size();
     }
 
-    bool doesNodeExist(int id) const
+    size_t memoryBytes() const
     {
-        return nodes.find(id) != nodes.end();
+        return parent.capacity() * sizeof(uint32_t) + set_size.capacity() * sizeof(uint32_t) + label.capacity() * sizeof(VertexId) + overlay.memoryBytes();
     }
+};
 
-    bool isNodeForeign(int id) const
+/*
+component adjacency graph. VertexId is the integer type of vertex ids and labels.
+
+the nodes live in a flat slot table that is found through a FlatIndex, and the neighbors of all nodes are stored as
+contiguous runs in one CSR array. the CSR array only changes in compact(): new edges are appended to pending_edges,
+contracted and removed nodes are only flagged, and compact() rebuilds the runs with every endpoint resolved through
+find(), dropping self loops, edges to removed nodes and duplicates (sort + unique per run).
+*/
+template <typename VertexId>
+class CAG
+{
+public:
+    struct Node
     {
-        if (nodes.find(id) == nodes.end())
-        {
-            throw std::runtime_error("Node does not exist");
-        }
-        else
+        VertexId id;
+        bool isForeign;
+        bool removed; // contracted into another node or dropped, the slot disappears in the next compact()
+    };
+
+    /*
+    a node that was contracted while it had foreign neighbors. the ranks of these neighbors still know it by its id, so
+    its id is handed on with the CAG until the ranges of all its foreign neighbors, [witness_min, witness_max], are merged
+    */
+    struct Alias
+    {
+        VertexId id;
+        VertexId witness_min;
+        VertexId witness_max;
+    };
+
+    typedef IdRange<VertexId> Neighbors;
+
+    std::vector<Node> nodes; // slots, neighbors(slot) is only valid while the CAG is compacted
+    DisjointSets<VertexId> union_find; // contracted labels, find() gives the node a label was contracted into
+    double contract_seconds = 0;        // time spent in completeMerge(), for the instrumentation
+    VertexId local_information_id_min;
+    VertexId local_information_id_max;
+    size_t nodes_before_contraction = 0; // nodes of the last contractLocalToLocalEdges() before it ran, for the instrumentation
+
+private:
+    FlatIndex<VertexId> index;
+    std::vector<size_t> offsets; // neighbors of slot s are adjacency[offsets[s]] .. adjacency[offsets[s + 1] - 1]
+    std::vector<VertexId> adjacency;
+    ScratchVector<std::pair<VertexId, VertexId>> pending_edges; // added since the last compact(), stored once per edge
+    bool compacted;
+    std::vector<Alias> aliases;
+
+    // scratch space of compact() and contractLocalToLocalEdges(). it keeps its capacity between the many compactions of
+    // one level of the reduction tree and is only given back in releaseScratch(), once per level
+    ScratchVector<VertexId> scratch_ids;
+    ScratchVector<std::pair<uint32_t, VertexId>> scratch_half_edges;
+    ScratchVector<size_t> scratch_fill;
+    ScratchVector<uint8_t> scratch_foreign; // isForeign of every slot while exchangeChunksAndMerge() sends the chunks
+
+    uint32_t slotOf(VertexId id) const
+    {
+        uint32_t slot = index.find(id);
+        if (slot == FlatIndex<VertexId>::NOT_FOUND || nodes[slot].removed)
         {
-            return nodes.at(id).isForeign;
+            return FlatIndex<VertexId>::NOT_FOUND;
         }
+        return slot;
     }
 
-    // Make a node local
-    void makeNodeLocal(int id)
+    uint32_t existingSlotOf(VertexId id) const
     {
-        if (nodes.find(id) == nodes.end())
+        uint32_t slot = slotOf(id);
+        if (slot == FlatIndex<VertexId>::NOT_FOUND)
         {
             throw std::runtime_error("Node does not exist");
         }
-        else
-        {
-            nodes[id].isForeign = false;
-        }
+        return slot;
     }
 
-    // Remove an edge between two nodes
-    void removeEdge(int from, int to)
+    /*a chunk of exchangeChunksAndMerge(), with the isForeign flags saved before the first merge*/
+    void appendChunk(size_t first_slot, size_t last_slot, ScratchVector<VertexId> &out)
     {
-        nodes[from].neighbors.erase(to);
-        nodes[to].neighbors.erase(from);
+        writeSerialized(first_slot, last_slot, out, [this](size_t slot)
+                        { return scratch_foreign[slot] != 0; });
     }
 
-    int find(int x)
+    void appendChunk(size_t first_slot, size_t last_slot, ScratchVector<uint8_t> &out)
     {
-        if (union_find.find(x) == union_find.end())
-        {
-            return x;
-        }
+        writeEncoded(first_slot, last_slot, out, [this](size_t slot)
+                     { return scratch_foreign[slot] != 0; });
+    }
 
-        while (union_find[x] != x)
-        {
-            x = union_find[x];
-        }
-        return x;
+    /// @brief header of exportTo(), followed by the node table, the offsets and the adjacency, each 8 byte aligned
+    struct ExportHeader
+    {
+        VertexId id_min;
+        VertexId id_max;
+        uint64_t nodes;
+        uint64_t adjacency;
+    };
+
+    static size_t align8(size_t bytes)
+    {
+        return (bytes + 7) & ~static_cast<size_t>(7);
     }
 
-    // Contract an edge between two nodes
-    void contractEdge(int u, int v)
+    /// @brief walks the node records of a CAG written by exportTo() in place, e.g. in the memory of another rank
+    class ExportedRecords
     {
+    private:
+        const Node *nodes;
+        const size_t *offsets;
+        const VertexId *adjacency;
+        size_t count;
+        size_t slot;
+
+    public:
+        VertexId id_min;
+        VertexId id_max;
+
+        ExportedRecords(const char *data) : slot(0)
+        {
+            const ExportHeader *header = reinterpret_cast<const ExportHeader *>(data);
+            count = header->nodes;
+            id_min = header->id_min;
+            id_max = header->id_max;
+            data += align8(sizeof(ExportHeader));
+            nodes = reinterpret_cast<const Node *>(data);
+            data += align8(count * sizeof(Node));
+            offsets = reinterpret_cast<const size_t *>(data);
+            data += align8((count + 1) * sizeof(size_t));
+            adjacency = reinterpret_cast<const VertexId *>(data);
+        }
 
-        if (nodes.find(u) != nodes.end() && nodes.find(v) != nodes.end())
+        bool next(NodeRecord<VertexId> &record)
         {
-            // Merge v's neighbors into u
-            for (auto neighbor : nodes[v].neighbors)
+            if (slot == count)
             {
-                if (neighbor != u)
-                { // Avoid self-loop
-                    nodes[u].neighbors.insert(neighbor);
-                    nodes[neighbor].neighbors.erase(v);
-                    nodes[neighbor].neighbors.insert(u);
-                }
+                return false;
             }
-            nodes[u].neighbors.erase(v);
+            record.id = nodes[slot].id;
+            record.isForeign = nodes[slot].isForeign;
+            record.neighbors = IdRange<VertexId>{adjacency + offsets[slot], adjacency + offsets[slot + 1]};
+            slot++;
+            return true;
+        }
+    };
 
-            // Update union-find only if v is in value set (not key set)
-            // if (values_in_union_find.find(v) != values_in_union_find.end()) {
-            /* union_find[v] = u;
-            union_find[u] = u;
-            values_in_union_find.insert(u); */
+    static SerializedRecords<VertexId> recordsOf(const VertexId *data, size_t size)
+    {
+        return SerializedRecords<VertexId>(data, size);
+    }
 
-            // or maybe instead
-            int current = v;
-            if (union_find.find(current) != union_find.end())
-                while (union_find[current] != current)
-                {
-                    int next = union_find[current];
-                    union_find[current] = u;
-                    current = next;
-                }
+    static EncodedRecords<VertexId> recordsOf(const uint8_t *data, size_t size)
+    {
+        (void)size;
+        return EncodedRecords<VertexId>(data);
+    }
 
-            union_find[current] = u;
-            union_find[u] = u;
-            values_in_union_find.insert(u);
+    /*fills the CAG with the records of a wire buffer, replacing what it held*/
+    template <typename Records>
+    void readRecords(Records &records)
+    {
+        local_information_id_min = records.id_min;
+        local_information_id_max = records.id_max;
 
-            //}
+        nodes.clear();
+        offsets.assign(1, 0);
+        adjacency.clear();
+        pending_edges.clear();
 
-            // Remove v from the graph
-            nodes.erase(v);
+        NodeRecord<VertexId> record;
+        while (records.next(record))
+        {
+            nodes.push_back(Node{record.id, record.isForeign, false});
+            adjacency.insert(adjacency.end(), record.neighbors.begin(), record.neighbors.end());
+            offsets.push_back(adjacency.size());
         }
-        else
+
+        index.clear(nodes.size());
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
         {
-            throw std::runtime_error("One or both nodes do not exist");
+            index.insert(nodes[slot].id, slot);
         }
+        compacted = true;
     }
 
-    void contractLocalToLocalEdges()
+    /*
+    the chunks are written one at a time into two alternating send buffers: chunk k + 1 is written and posted while the
+    partner's chunk k is merged. the partner's chunks go to two reused receive buffers, the next one is received while
+    the current one is merged if its message already arrived. the chunk counts are swapped first, the sizes come from
+    MPI_Probe.
+    */
+    template <typename T>
+    void exchangeChunksAndMerge(const std::vector<size_t> &bounds, MPI_Datatype type, int partner_rank, WireBytes &bytes)
     {
-        std::vector<std::pair<int, int>> edgesToContract;
+        int chunk_count = bounds.size() - 1;
+        int partner_chunk_count;
+        MPI_Sendrecv(&chunk_count, 1, MPI_INT, partner_rank, 0, &partner_chunk_count, 1, MPI_INT, partner_rank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
-        for (auto &nodePair : nodes)
+        // merging makes foreign nodes local, the chunks still to be sent have to carry the flags from before
+        scratch_foreign.resize(nodes.size());
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
         {
-            nodePair.second.is_next_to_foreign = false;
+            scratch_foreign[slot] = nodes[slot].isForeign;
         }
 
-        // Step 1: Collect edges to contract
-        for (const auto &nodePair : nodes)
+        ScratchVector<T> send_buffers[2];
+        MPI_Request sends[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+        auto post_send = [&](int k)
         {
-            if (nodePair.second.isForeign)
-            {
-                for (int neighbor : nodePair.second.neighbors)
-                {
-                    nodes[neighbor].is_next_to_foreign = true;
-                }
-                continue;
-            }
-            int u = nodePair.first;
-            for (int v : nodePair.second.neighbors)
+            ScratchVector<T> &buffer = send_buffers[k % 2];
+            MPI_Wait(&sends[k % 2], MPI_STATUS_IGNORE);
+            buffer.clear();
+            appendChunk(bounds[k], bounds[k + 1], buffer);
+            bytes.encoded += buffer.size() * sizeof(T);
+            MPI_Isend(buffer.data(), buffer.size(), type, partner_rank, 0, MPI_COMM_WORLD, &sends[k % 2]);
+        };
+
+        ScratchVector<T> receive_buffers[2];
+        int receive_sizes[2] = {0, 0};
+        MPI_Request receives[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+        int posted_receives = 0;
+        auto post_receive = [&](const MPI_Status &status)
+        {
+            int k = posted_receives++;
+            ScratchVector<T> &buffer = receive_buffers[k % 2];
+            MPI_Get_count(&status, type, &receive_sizes[k % 2]);
+            if (buffer.size() < static_cast<size_t>(receive_sizes[k % 2]))
             {
-                if (u < v && !nodes[v].isForeign)
-                { // Ensure each edge is only considered once
-                    edgesToContract.emplace_back(u, v);
-                }
+                buffer.resize(receive_sizes[k % 2]);
             }
-        }
+            MPI_Irecv(buffer.data(), receive_sizes[k % 2], type, partner_rank, 0, MPI_COMM_WORLD, &receives[k % 2]);
+        };
 
-        // Step 2: Contract edges
-        for (const auto &edge : edgesToContract)
+        if (chunk_count > 0)
         {
-            int u = find(edge.first);
-            int v = find(edge.second);
-
-            int smaller = std::min(u, v);
-            int larger = std::max(u, v);
-
-            if (smaller == larger)
+            post_send(0);
+        }
+        VertexId received_min = 0;
+        VertexId received_max = 0;
+        for (int k = 0; k < std::max(chunk_count, partner_chunk_count); ++k)
+        {
+            if (k + 1 < chunk_count)
+            {
+                post_send(k + 1);
+            }
+            if (k >= partner_chunk_count)
             {
                 continue;
-                std::cout << "this case should not really happen anymore i think..." << std::endl;
             }
 
-            if (nodes[larger].is_next_to_foreign)
+            MPI_Status status;
+            if (posted_receives == k)
             {
-                continue;
+                MPI_Probe(partner_rank, 0, MPI_COMM_WORLD, &status);
+                post_receive(status);
+            }
+            MPI_Wait(&receives[k % 2], MPI_STATUS_IGNORE);
+            int arrived = 0;
+            if (posted_receives < partner_chunk_count)
+            {
+                MPI_Iprobe(partner_rank, 0, MPI_COMM_WORLD, &arrived, &status);
+            }
+            if (arrived)
+            {
+                post_receive(status);
             }
 
-            contractEdge(smaller, larger);
+            auto records = recordsOf(receive_buffers[k % 2].data(), receive_sizes[k % 2]);
+            mergeRecords(records);
+            received_min = records.id_min;
+            received_max = records.id_max;
         }
+        MPI_Waitall(2, sends, MPI_STATUSES_IGNORE);
+
+        completeMerge(received_min, received_max);
     }
 
-    // Optional: Method to display the graph (for debugging or visualization purposes)
-    void displayGraph() const
+public:
+    CAG() : offsets(1, 0), compacted(true) {}
+
+    /*serializes the nodes of the slots [first_slot, last_slot) into a vector, by default the whole CAG*/
+    std::vector<VertexId> serialize(size_t first_slot = 0, size_t last_slot = SIZE_MAX)
     {
-        for (const auto &pair : nodes)
-        {
-            std::cout << "Node " << pair.first << ": ";
-            for (int neighbor : pair.second.neighbors)
-            {
-                std::cout << neighbor << " ";
-            }
-            std::cout << std::endl;
-        }
+        std::vector<VertexId> data;
+        appendSerialized(first_slot, last_slot, data);
+        return data;
     }
 
-    CAG sendAndReceive(int partner_rank)
+    /*appends serialize(first_slot, last_slot) to data*/
+    void appendSerialized(size_t first_slot, size_t last_slot, std::vector<VertexId> &data)
     {
-        // Serialize the current CAG instance
-        std::vector<int> serializedData = serialize();
+        compact();
+        writeSerialized(first_slot, last_slot, data, [this](size_t slot)
+                        { return nodes[slot].isForeign; });
+    }
 
-        // Determine the size of the serialized data
-        int dataSize = serializedData.size();
+    /*serializes the compacted CSR runs, isForeign(slot) gives the flag of a node*/
+    template <typename Buffer, typename ForeignFlag>
+    void writeSerialized(size_t first_slot, size_t last_slot, Buffer &data, ForeignFlag isForeign)
+    {
+        last_slot = std::min(last_slot, nodes.size());
+        data.reserve(data.size() + 3 + (last_slot - first_slot) * 3 + offsets[last_slot] - offsets[first_slot]);
 
-        // Exchange the size information
-        int partnerDataSize;
-        MPI_Sendrecv(&dataSize, 1, MPI_INT, partner_rank, 0,
-                     &partnerDataSize, 1, MPI_INT, partner_rank, 0,
-                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-        // Allocate space for the partner's data
-        std::vector<int> partnerData(partnerDataSize);
+        data.push_back(local_information_id_min);
+        data.push_back(local_information_id_max);
 
-        // Exchange the serialized data
-        MPI_Sendrecv(serializedData.data(), dataSize, MPI_INT, partner_rank, 0,
-                     partnerData.data(), partnerDataSize, MPI_INT, partner_rank, 0,
-                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        // Serialize each node: id, isForeign (as 0 or 1), number of neighbors, neighbors
+        for (size_t slot = first_slot; slot < last_slot; ++slot)
+        {
+            data.push_back(nodes[slot].id);
+            data.push_back(isForeign(slot) ? 1 : 0);
+            data.push_back(offsets[slot + 1] - offsets[slot]);
+            data.insert(data.end(), adjacency.begin() + offsets[slot], adjacency.begin() + offsets[slot + 1]);
+        }
 
-        // Deserialize the received data into a new CAG instance
-        CAG newCAG;
-        newCAG.deserialize(partnerData);
-        return newCAG;
+        // Add a special marker at the end (e.g., -1) to indicate the end of data
+        data.push_back(-1);
     }
-};
 
-class Graph
-{
-private:
-    void DFS(int v, std::vector<bool> &visited, int label, std::vector<int> &components)
+    void deserialize(const std::vector<VertexId> &data)
     {
-        std::stack<int> stack;
-        stack.push(v);
-
-        while (!stack.empty())
-        {
-            v = stack.top();
-            stack.pop();
-
-            if (!visited[v - startVertexIndex])
-            {
-                visited[v - startVertexIndex] = true;
-                components[v - startVertexIndex] = label;
-
-                for (int i : (this->operator[](v)))
-                {
-                    if (i >= startVertexIndex && i < startVertexIndex + vertexCount && !visited[i - startVertexIndex])
-                    {
-                        stack.push(i);
-                    }
-                    else if (i < startVertexIndex || i >= startVertexIndex + vertexCount)
-                    {
-                        foreign_to_local_edges[i].push_back(v);
-                        local_to_foreign_nodes[v].push_back(i);
-                    }
-                }
-            }
-        }
+        deserialize(data.data(), data.size());
     }
 
-    // std::vector<std::vector<int>> adjList;
+    /*the serialized runs are already symmetric and deduplicated, so they are copied into the CSR array as they are*/
+    void deserialize(const VertexId *data, size_t size)
+    {
+        adjacency.reserve(size);
+        SerializedRecords<VertexId> records(data, size);
+        readRecords(records);
+    }
 
-public:
-    int startVertexIndex;
-    int vertexCount;
-    std::vector<std::vector<int>> adjList;
-    std::unordered_map<int, std::vector<int>> foreign_to_local_edges;
-    std::unordered_map<int, std::vector<int>> local_to_foreign_nodes;
+    /*size of exportTo() in bytes*/
+    size_t exportedBytes()
+    {
+        compact();
+        return align8(sizeof(ExportHeader)) + align8(nodes.size() * sizeof(Node)) + align8(offsets.size() * sizeof(size_t)) +
+               adjacency.size() * sizeof(VertexId);
+    }
 
-    /*default constructor*/
-    Graph() : startVertexIndex(0), vertexCount(0) {}
-    /*complete graph*/
-    Graph(int vertexCount) : startVertexIndex(0), vertexCount(vertexCount), adjList(vertexCount) {}
-    /*subgraph*/
-    Graph(int vertexCount, int startVertexIndex) : startVertexIndex(startVertexIndex), vertexCount(vertexCount), adjList(vertexCount) {}
+    /*
+    copies the node table and the CSR arrays as they are to out, which has exportedBytes(). unlike serialize(), the copy
+    is only readable by the same binary, so it is meant for ranks that share memory, see mergeFromPeers()
+    */
+    void exportTo(char *out)
+    {
+        compact();
+        ExportHeader header = {local_information_id_min, local_information_id_max, nodes.size(), adjacency.size()};
+        memcpy(out, &header, sizeof(header));
+        out += align8(sizeof(ExportHeader));
+        memcpy(out, nodes.data(), nodes.size() * sizeof(Node));
+        out += align8(nodes.size() * sizeof(Node));
+        memcpy(out, offsets.data(), offsets.size() * sizeof(size_t));
+        out += align8(offsets.size() * sizeof(size_t));
+        memcpy(out, adjacency.data(), adjacency.size() * sizeof(VertexId));
+    }
 
-    // Overload the subscript operator to provide the desired offset functionality.
-    std::vector<int> &operator[](size_t index)
+    /*size of serialize() in bytes*/
+    size_t serializedBytes()
     {
-        // Adjust index by the offset.
-        size_t adjustedIndex = index - startVertexIndex;
+        compact();
+        return (3 + nodes.size() * 3 + adjacency.size()) * sizeof(VertexId);
+    }
 
-        // Check for out-of-bounds access.
-        if (adjustedIndex >= adjList.size() || adjustedIndex < 0)
-        {
-            throw std::out_of_range("Index out of range");
-        }
+    /*
+    compact counterpart of serialize(): min and max - min, the node count, then per node the id as delta to the previous
+    node id, 2 * neighbor count + isForeign, and the neighbors as deltas to the previous neighbor (the first one to the node
+    id). all deltas are zigzag varints; the runs are sorted after compact(), so the gaps are small positive numbers.
+    */
+    std::vector<uint8_t> encode(size_t first_slot = 0, size_t last_slot = SIZE_MAX)
+    {
+        std::vector<uint8_t> data;
+        appendEncoded(first_slot, last_slot, data);
+        return data;
+    }
 
-        return adjList[adjustedIndex];
+    /*appends encode(first_slot, last_slot) to data*/
+    void appendEncoded(size_t first_slot, size_t last_slot, std::vector<uint8_t> &data)
+    {
+        compact();
+        writeEncoded(first_slot, last_slot, data, [this](size_t slot)
+                     { return nodes[slot].isForeign; });
     }
 
-    // Const overload of the subscript operator for const contexts.
-    const std::vector<int> &operator[](size_t index) const
+    /*encodes the compacted CSR runs, isForeign(slot) gives the flag of a node*/
+    template <typename Buffer, typename ForeignFlag>
+    void writeEncoded(size_t first_slot, size_t last_slot, Buffer &data, ForeignFlag isForeign)
     {
-        size_t adjustedIndex = index - startVertexIndex;
+        last_slot = std::min(last_slot, nodes.size());
+        data.reserve(data.size() + 16 + (last_slot - first_slot) * 4 + (offsets[last_slot] - offsets[first_slot]) * 2);
 
-        // Check for out-of-bounds access.
-        if (adjustedIndex >= adjList.size() || adjustedIndex < 0)
+        appendVarint(data, zigzag(local_information_id_min));
+        appendVarint(data, zigzag(static_cast<int64_t>(local_information_id_max) - local_information_id_min));
+        appendVarint(data, last_slot - first_slot);
+
+        int64_t previous_id = local_information_id_min;
+        for (size_t slot = first_slot; slot < last_slot; ++slot)
         {
-            throw std::out_of_range("Index out of range");
-        }
+            appendVarint(data, zigzag(nodes[slot].id - previous_id));
+            previous_id = nodes[slot].id;
+            appendVarint(data, (offsets[slot + 1] - offsets[slot]) * 2 + (isForeign(slot) ? 1 : 0));
 
-        return adjList[adjustedIndex];
+            int64_t previous_neighbor = nodes[slot].id;
+            for (size_t e = offsets[slot]; e < offsets[slot + 1]; ++e)
+            {
+                appendVarint(data, zigzag(adjacency[e] - previous_neighbor));
+                previous_neighbor = adjacency[e];
+            }
+        }
     }
 
-    /*absolute positions*/
-    void addEdge(int v, int w)
+    void decode(const std::vector<uint8_t> &data)
     {
-        this->operator[](v).push_back(w);
-        this->operator[](w).push_back(v);
+        decode(data.data());
     }
 
-    /*absolute positions*/
-    void addDirectedEdge(int v, int w)
+    /*the encoding carries its node count, so it needs no size*/
+    void decode(const uint8_t *in)
     {
-        this->operator[](v).push_back(w);
+        EncodedRecords<VertexId> records(in);
+        readRecords(records);
     }
 
-    /*prints the current graph*/
-    void print()
+    /*rebuilds the node table and the CSR runs, applying all contractions, removals and pending edges*/
+    void compact()
     {
-        for (int i = 0; i < vertexCount; ++i)
+        if (compacted)
         {
-            std::cout << i + startVertexIndex << ": ";
-            for (int w : adjList[i])
-            {
-                std::cout << w << " ";
-            }
-            std::cout << std::endl;
+            return;
         }
-    }
 
-    void printWithDashes()
-    {
-        for (int i = 0; i < vertexCount; ++i)
+        // keep the slots that are still alive, in their order. the adjacency still refers to the old slots by their ids
+        ScratchVector<VertexId> &old_ids = scratch_ids;
+        old_ids.clear();
+        size_t alive = 0;
+        for (const Node &node : nodes)
         {
-            for (int w : adjList[i])
+            old_ids.push_back(node.id);
+            if (!node.removed)
             {
-                if (i + startVertexIndex <= w)
-                    std::cout << i + startVertexIndex << "-" << w << std::endl;
+                nodes[alive++] = node;
             }
         }
-    }
+        nodes.resize(alive);
+        index.clear(nodes.size());
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
+        {
+            index.insert(nodes[slot].id, slot);
+        }
 
-    /*vertices contain vertex ids (absolute). "from" and "to" are the ids of the specified range of vertices (including "to").*/
-    void sendSubgraph(int dest, int from, int to, MPI_Comm comm)
-    {
-        // Calculate the size of the buffer
-        int bufferSize = sizeof(int);                // For storing the size of the vertices vector
-        bufferSize += sizeof(int) * (to - from + 1); // For storing the vertices
-        for (int v = from; v <= to; ++v)
+        // resolve both endpoints of every edge through find(). the old runs are symmetric, pending edges are stored once
+        ScratchVector<std::pair<uint32_t, VertexId>> &half_edges = scratch_half_edges;
+        half_edges.clear();
+        half_edges.reserve(adjacency.size() + pending_edges.size() * 2);
+        auto resolve = [&](VertexId from, VertexId to)
+        {
+            VertexId from_root = find(from);
+            VertexId to_root = find(to);
+            if (from_root == to_root)
+            {
+                return; // Avoid self-loop
+            }
+            uint32_t from_slot = slotOf(from_root);
+            if (from_slot != FlatIndex<VertexId>::NOT_FOUND && slotOf(to_root) != FlatIndex<VertexId>::NOT_FOUND)
+            {
+                half_edges.emplace_back(from_slot, to_root);
+            }
+        };
+        for (size_t slot = 0; slot + 1 < offsets.size(); ++slot)
         {
-            if (v < startVertexIndex || v >= startVertexIndex + vertexCount)
+            for (size_t e = offsets[slot]; e < offsets[slot + 1]; ++e)
             {
-                throw std::out_of_range("vertices contains an invalid vertex id");
+                resolve(old_ids[slot], adjacency[e]);
             }
-            bufferSize += sizeof(int);                              // For storing the size of the adjacency list
-            bufferSize += sizeof(int) * this->operator[](v).size(); // For storing the adjacency list
         }
+        for (const auto &edge : pending_edges)
+        {
+            resolve(edge.first, edge.second);
+            resolve(edge.second, edge.first);
+        }
+        old_ids.clear();
+        pending_edges.clear();
 
-        // Allocate the buffer
-        char *buffer = new char[bufferSize];
-        int position = 0;
-
-        // Pack the data into the buffer
-        int size = to - from + 1;
-        MPI_Pack(&size, 1, MPI_INT, buffer, bufferSize, &position, comm);
-        MPI_Pack(&from, 1, MPI_INT, buffer, bufferSize, &position, comm);
-        for (int v = from; v <= to; ++v)
+        // counting sort by slot, then sort + unique within every run
+        offsets.assign(nodes.size() + 1, 0);
+        for (const auto &half_edge : half_edges)
+        {
+            offsets[half_edge.first + 1]++;
+        }
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
         {
-            size = this->operator[](v).size();
-            MPI_Pack(&size, 1, MPI_INT, buffer, bufferSize, &position, comm);
-            MPI_Pack(this->operator[](v).data(), size, MPI_INT, buffer, bufferSize, &position, comm);
+            offsets[slot + 1] += offsets[slot];
         }
+        adjacency.resize(half_edges.size());
+        scratch_fill.assign(offsets.begin(), offsets.end() - 1);
+        for (const auto &half_edge : half_edges)
+        {
+            adjacency[scratch_fill[half_edge.first]++] = half_edge.second;
+        }
+        half_edges.clear();
 
-        // Send the buffer
-        MPI_Send(buffer, position, MPI_PACKED, dest, 0, comm);
+        size_t write = 0;
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
+        {
+            size_t begin = offsets[slot];
+            size_t end = offsets[slot + 1];
+            std::sort(adjacency.begin() + begin, adjacency.begin() + end);
+            offsets[slot] = write;
+            for (size_t e = begin; e < end; ++e)
+            {
+                if (e == begin || adjacency[e] != adjacency[e - 1])
+                {
+                    adjacency[write++] = adjacency[e];
+                }
+            }
+        }
+        offsets[nodes.size()] = write;
+        adjacency.resize(write);
 
-        // Free the buffer
-        delete[] buffer;
+        compacted = true;
     }
 
-    /*receives a graph*/
-    static Graph receiveSubgraph(int source, MPI_Comm comm)
+    /*gives the scratch space and the slack of the node table and the adjacency back, the CAG stays as it is*/
+    void releaseScratch()
     {
-        MPI_Status status;
-        int bufferSize;
-
-        // Probe for the incoming message to find out its size
-        MPI_Probe(source, 0, comm, &status);
-        MPI_Get_count(&status, MPI_PACKED, &bufferSize);
+        ScratchVector<VertexId>().swap(scratch_ids);
+        ScratchVector<std::pair<uint32_t, VertexId>>().swap(scratch_half_edges);
+        ScratchVector<size_t>().swap(scratch_fill);
+        ScratchVector<uint8_t>().swap(scratch_foreign);
+        ScratchVector<std::pair<VertexId, VertexId>>().swap(pending_edges);
+        nodes.shrink_to_fit();
+        offsets.shrink_to_fit();
+        adjacency.shrink_to_fit();
+    }
 
-        // Allocate a buffer to receive the data
-        char *buffer = new char[bufferSize];
-        MPI_Recv(buffer, bufferSize, MPI_PACKED, source, 0, comm, &status);
+    /*neighbors of a slot, the CAG has to be compacted*/
+    Neighbors neighbors(size_t slot) const
+    {
+        return Neighbors{adjacency.data() + offsets[slot], adjacency.data() + offsets[slot + 1]};
+    }
 
-        // Unpack the buffer
-        int position = 0;
-        int size;
-        int rec_startVertexIndex;
+    size_t edgeCount()
+    {
+        compact();
+        return adjacency.size() / 2;
+    }
 
-        MPI_Unpack(buffer, bufferSize, &position, &size, 1, MPI_INT, comm);
-        MPI_Unpack(buffer, bufferSize, &position, &rec_startVertexIndex, 1, MPI_INT, comm);
-        Graph subgraph(size, rec_startVertexIndex);
-        for (int v = rec_startVertexIndex, stop = rec_startVertexIndex + size; v < stop; ++v)
-        {
-            MPI_Unpack(buffer, bufferSize, &position, &size, 1, MPI_INT, comm);
-            subgraph[v].resize(size);
-            MPI_Unpack(buffer, bufferSize, &position, subgraph[v].data(), size, MPI_INT, comm);
-        }
+    /*bytes held by the node table, the index, the adjacency and the scratch space*/
+    size_t memoryBytes() const
+    {
+        return nodes.capacity() * sizeof(Node) + index.memoryBytes() + offsets.capacity() * sizeof(size_t) +
+               adjacency.capacity() * sizeof(VertexId) + pending_edges.capacity() * sizeof(std::pair<VertexId, VertexId>) +
+               scratch_ids.capacity() * sizeof(VertexId) + scratch_half_edges.capacity() * sizeof(std::pair<uint32_t, VertexId>) +
+               scratch_fill.capacity() * sizeof(size_t) + scratch_foreign.capacity() + aliases.capacity() * sizeof(Alias);
+    }
 
-        // Free the buffer
-        delete[] buffer;
-        return subgraph;
+    // Add a new node to the graph
+    void addNode(VertexId id)
+    {
+        addNode(id, false);
     }
 
-    /*creates a subgraph. "from" and "to" are the ids of the specified range of vertices (including "to").*/
-    Graph createSubgraph(int from, int to)
+    void addNode(VertexId id, bool isForeign)
     {
-        if (from < startVertexIndex || to >= startVertexIndex + vertexCount || from > to)
+        uint32_t slot = slotOf(id);
+        if (slot == FlatIndex<VertexId>::NOT_FOUND)
         {
-            throw std::out_of_range("Invalid range for subgraph creation");
+            // a removed node with the same id keeps its old slot until the next compact()
+            index.insert(id, nodes.size());
+            nodes.push_back(Node{id, isForeign, false});
+            compacted = false;
         }
-
-        int subgraphVertexCount = to - from + 1;
-        Graph subgraph(subgraphVertexCount, from);
-
-        // Adjust the indices for the new subgraph
-        for (int i = from; i <= to; ++i)
+        else
         {
-            for (int neighbor : this->operator[](i))
+            if (nodes[slot].isForeign != isForeign)
             {
-                // Include only the edges where the neighbor is within the new subgraph's range
-                subgraph[i].push_back(neighbor);
+                throw std::runtime_error("Node already exists with different isForeign value.");
             }
         }
-
-        return subgraph;
     }
 
-    /*returns a vector containing the labels of vertices in the graph. ret[i-startVertexIndex] is label of vertex with id i*/
-    std::vector<int> connectedComponents()
+    // Add an edge between two nodes
+    void addEdge(VertexId from, VertexId to)
     {
-        std::vector<bool> visited(vertexCount, false);
-        std::vector<int> components(vertexCount, -1); // -1 means unvisited
-        int label = startVertexIndex;
-
-        for (int v = startVertexIndex; v < startVertexIndex + vertexCount; ++v)
+        // Check if 'from' node exists, if not, add it
+        if (!doesNodeExist(from))
         {
-            if (!visited[v - startVertexIndex])
-            {
-                DFS(v, visited, label, components);
-                label++; // Increment label for next component
-            }
+            addNode(from);
         }
-        return components;
-    }
 
-    CAG createCAG(std::vector<int> &connectedComponents, std::unordered_map<int, int> &foreign_ID_to_label)
-    {
-        CAG cag;
-        for (int i = startVertexIndex; i < startVertexIndex + vertexCount; ++i)
+        // Check if 'to' node exists, if not, add it
+        if (!doesNodeExist(to))
         {
-            for (int j : (this->operator[](i)))
-            {
-                // vertex i is connected to vertex j
-                if (j < startVertexIndex || j >= startVertexIndex + vertexCount)
-                { // j is a foreign node
-                    cag.addEdgeLocalToForeign(connectedComponents[i - startVertexIndex], foreign_ID_to_label[j]);
-                }
-            }
+            addNode(to);
         }
-        return cag;
+
+        pending_edges.emplace_back(from, to);
+        compacted = false;
     }
-};
 
-Graph generateRandomGraph(int num_nodes, int num_edges)
-{
-    Graph g(num_nodes);
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(0, num_nodes - 1);
+    /*adds an edge without creating missing endpoints. edges whose endpoints do not exist at the next compact() are dropped*/
+    void linkNodes(VertexId from, VertexId to)
+    {
+        pending_edges.emplace_back(from, to);
+        compacted = false;
+    }
 
-    for (int i = 0; i < num_edges; ++i)
+    void addEdgeLocalToForeign(VertexId from, VertexId to)
     {
-        int u = distrib(gen);
-        int v = distrib(gen);
-        if (u == v)
+        // Check if 'from' node exists, if not, add it
+        if (!doesNodeExist(from))
         {
-            --i;
-            continue;
+            addNode(from);
         }
-        g.addEdge(u, v);
-    }
-
-    return g;
-}
-
-// Function to read the 'vertices' integer from an opened HDF5 file
-int readVerticesFromHDF5File(H5::H5File &file)
-{
-    // Open the dataset 'vertices'
-    H5::DataSet datasetVertices = file.openDataSet("vertices");
-
-    // Prepare a variable to store the vertices value
-    int vertices;
-    datasetVertices.read(&vertices, H5::PredType::NATIVE_INT);
-
-    return vertices;
-}
-
-std::vector<std::vector<int>> readLinesFromHDF5(H5::H5File &file, int startLine, int endLine)
-{
-    std::vector<std::vector<int>> lines;
 
-    H5::DataSet datasetLookup = file.openDataSet("lookup");
-    H5::DataSet datasetData = file.openDataSet("data");
-
-    H5::DataSpace dataspaceLookup = datasetLookup.getSpace();
-    H5::DataSpace dataspaceData = datasetData.getSpace();
-
-    // Read the lookup indices for the start and end lines
-    hsize_t count[2] = {static_cast<hsize_t>(endLine - startLine + 1), 2};
-    hsize_t offset[2] = {static_cast<hsize_t>(startLine), 0};
-    dataspaceLookup.selectHyperslab(H5S_SELECT_SET, count, offset);
-    hsize_t dimLookupRead[2] = {count[0], 2};
-    H5::DataSpace memspaceLookup(2, dimLookupRead);
-
-    std::vector<int> lookup(count[0] * 2); // Buffer for lookup indices
-    datasetLookup.read(lookup.data(), H5::PredType::NATIVE_INT, memspaceLookup, dataspaceLookup);
-
-    int startIdx = lookup[0];
-    int endIdx = lookup[(endLine - startLine) * 2 + 1]; // End index of endLine
-
-    // Read the data chunk
-    hsize_t dataSize = static_cast<hsize_t>(endIdx - startIdx + 1);
-    hsize_t dataOffset[1] = {static_cast<hsize_t>(startIdx)};
-    dataspaceData.selectHyperslab(H5S_SELECT_SET, &dataSize, dataOffset);
-    std::vector<int> chunk(dataSize);
-    H5::DataSpace memspaceData(1, &dataSize);
-    datasetData.read(chunk.data(), H5::PredType::NATIVE_INT, memspaceData, dataspaceData);
-
-    // Process the data chunk
-    std::vector<int> line;
-    int should_be = startLine;
-    bool first_number_in_line = true;
-    for (int num : chunk)
-    {
-        if (num == -1)
-        {
-            lines.push_back(line);
-            line.clear();
-            should_be++;
-            first_number_in_line = true;
+        // Check if 'to' node exists, if not, add it
+        if (!doesNodeExist(to))
+        {
+            addNode(to, true);
         }
         else
         {
-            if (first_number_in_line)
-            {
-                first_number_in_line = false;
-                if (num != should_be)
-                {
-                    std::cout << "Error: " << num << " should be " << should_be << std::endl;
-                    throw std::runtime_error("Error: file vertice at line " + std::to_string(num) + " should be " + std::to_string(should_be));
-                }
-            }
-            else
+            if (!isNodeForeign(to))
             {
-                line.push_back(num);
+                throw std::runtime_error("Node already exists with different isForeign value..");
             }
         }
-    }
-
-    return lines;
-}
-
-int run(int mpi_rank, int mpi_size)
-{
 
-    int xx = 0;
-    while (DEBUG_CONDITION && xx == 0 /*  && mpi_rank == RANK_OF_INTEREST */)
-    {
-        sleep(5);
+        pending_edges.emplace_back(from, to);
+        compacted = false;
     }
 
-    H5::H5File file("data/coauth-DBLP-full-proj-graph-LIST_REMAP.h5", H5F_ACC_RDONLY);
-    int total_vertices = readVerticesFromHDF5File(file);
-
-    int verticesPerProcess = total_vertices / mpi_size;
-    if (verticesPerProcess == 0)
+    bool doesNodeExist(VertexId id) const
     {
-        throw std::runtime_error("Too many processes for amount of nodes");
+        return slotOf(id) != FlatIndex<VertexId>::NOT_FOUND;
     }
 
-    int my_start_vertex_id = -1;
-    int my_end_vertex_id = -1;
-    if (mpi_rank == mpi_size - 1)
+    bool isNodeForeign(VertexId id) const
     {
-        my_start_vertex_id = verticesPerProcess * mpi_rank;
-        my_end_vertex_id = total_vertices - 1;
+        return nodes[existingSlotOf(id)].isForeign;
     }
-    else
+
+    // Make a node local
+    void makeNodeLocal(VertexId id)
     {
-        my_start_vertex_id = verticesPerProcess * mpi_rank;
-        my_end_vertex_id = verticesPerProcess * (mpi_rank + 1) - 1;
+        nodes[existingSlotOf(id)].isForeign = false;
     }
 
-    Graph g_sub = Graph(my_end_vertex_id - my_start_vertex_id + 1, my_start_vertex_id);
-    std::vector<std::vector<int>> lines = readLinesFromHDF5(file, my_start_vertex_id, my_end_vertex_id);
-    for (size_t i = 0; i < lines.size(); ++i)
+    /*drops all foreign nodes with ids in [min, max] together with their edges*/
+    void removeForeignNodes(VertexId min, VertexId max)
     {
-        for (int neighbor : lines[i])
+        for (Node &node : nodes)
         {
-            g_sub.addDirectedEdge(i + my_start_vertex_id, neighbor);
+            if (!node.removed && node.id >= min && node.id <= max && node.isForeign)
+            {
+                node.removed = true;
+                compacted = false;
+            }
         }
     }
 
-    std::vector<int> labels = g_sub.connectedComponents();
-
-    std::vector<int> local_list; // contains the following information: [localnode, cc_id, localnode, cc_id, ...]
-    for (const auto &node : g_sub.local_to_foreign_nodes)
+    VertexId find(VertexId x)
     {
-        local_list.push_back(node.first);
-        local_list.push_back(labels[node.first - g_sub.startVertexIndex]);
+        return union_find.find(x);
     }
 
-    // exchange borders with all other processes
-    //  Step 1: Gather sizes of each list
-    std::vector<int> list_sizes(mpi_size);
-    int local_list_size = local_list.size();
-    MPI_Allgather(&local_list_size, 1, MPI_INT, list_sizes.data(), 1, MPI_INT, MPI_COMM_WORLD);
-
-    // Step 2: Compute displacements
-    std::vector<int> displacements(mpi_size);
-    int total_size = 0;
-    for (int i = 0; i < mpi_size; ++i)
+    /*
+    contracts all local-local edges in one pass: their endpoints are united in the union-find, where the smaller label
+    survives, and every local node that is no longer the label of its set is flagged, so the next compact() rebuilds the
+    CAG once with the edges of the contracted nodes moved to their labels and deduplicated
+    */
+    void contractLocalToLocalEdges()
     {
-        displacements[i] = total_size;
-        total_size += list_sizes[i];
-    }
+        compact();
+        nodes_before_contraction = nodes.size();
 
-    // Prepare a vector to receive the gathered data
-    std::vector<int> gathered_list(total_size);
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
+        {
+            if (nodes[slot].isForeign)
+            {
+                continue;
+            }
+            VertexId u = nodes[slot].id;
+            for (VertexId v : neighbors(slot))
+            {
+                if (u < v && !isNodeForeign(v))
+                {
+                    // a component always ends up with its smallest label on every rank
+                    VertexId u_label = find(u);
+                    VertexId v_label = find(v);
+                    if (u_label != v_label)
+                    {
+                        union_find.unite(u_label, v_label, std::min(u_label, v_label));
+                    }
+                }
+            }
+        }
 
-    // Step 3: Gather the lists
-    MPI_Allgatherv(local_list.data(), local_list_size, MPI_INT,
-                   gathered_list.data(), list_sizes.data(), displacements.data(),
-                   MPI_INT, MPI_COMM_WORLD);
+        // foreign nodes are never contracted, so the flags can be set while the neighbors are looked at
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
+        {
+            if (nodes[slot].isForeign || find(nodes[slot].id) == nodes[slot].id)
+            {
+                continue;
+            }
+            nodes[slot].removed = true;
+            compacted = false;
 
-    std::unordered_map<int, int> foreign_ID_to_label;
-    for (int i = 0; i < total_size; i += 2)
-    { // TODO can optimize out own local nodes
-        foreign_ID_to_label[gathered_list[i]] = gathered_list[i + 1];
+            Alias alias = {nodes[slot].id, 0, 0};
+            bool next_to_foreign = false;
+            for (VertexId neighbor : neighbors(slot))
+            {
+                if (nodes[index.find(neighbor)].isForeign)
+                {
+                    alias.witness_min = next_to_foreign ? std::min(alias.witness_min, neighbor) : neighbor;
+                    alias.witness_max = next_to_foreign ? std::max(alias.witness_max, neighbor) : neighbor;
+                    next_to_foreign = true;
+                }
+            }
+            if (next_to_foreign)
+            {
+                aliases.push_back(alias);
+            }
+        }
     }
 
-    CAG cag = g_sub.createCAG(labels, foreign_ID_to_label);
-
-    cag.local_information_id_min = g_sub.startVertexIndex;
-    cag.local_information_id_max = g_sub.startVertexIndex + g_sub.vertexCount - 1;
-
-    for (int label : labels)
+    /*the aliases as (id, label, witness_min, witness_max) quadruples, see Alias*/
+    std::vector<VertexId> serializeAliases()
     {
-        cag.union_find[label] = label;
-        cag.values_in_union_find.insert(label);
+        std::vector<VertexId> data;
+        data.reserve(aliases.size() * 4);
+        for (const Alias &alias : aliases)
+        {
+            data.push_back(alias.id);
+            data.push_back(find(alias.id));
+            data.push_back(alias.witness_min);
+            data.push_back(alias.witness_max);
+        }
+        return data;
     }
 
-    // calculating reduction tree
-    int partners_size = (int)(log(mpi_size) / log(2.0));
-    assert((int)pow(2, partners_size) == mpi_size && "mpi_size must be power of 2 for the reduction tree (temporarily)");
-    std::vector<int> partners(partners_size);
-
+    /*
+    takes over the aliases of the CAG about to be merged, before any of its nodes: a node or edge of the merged CAG may
+    refer to a node of this CAG that was contracted on a rank this one never exchanged with
+    */
+    void mergeAliases(const std::vector<VertexId> &data)
     {
-        int nxt_distance = 1;
-        int index = 0;
-        while (nxt_distance < mpi_size)
+        for (size_t i = 0; i + 3 < data.size(); i += 4)
         {
-            int temp = int((mpi_rank) / nxt_distance);
-            int skip = 0;
-
-            if (temp % 2 == 1)
-                skip = -nxt_distance;
-            else
-                skip = nxt_distance;
-
-            partners[index++] = mpi_rank + skip;
-
-            nxt_distance *= 2;
+            union_find.unite(data[i], data[i + 1], find(data[i + 1]));
+            aliases.push_back(Alias{data[i], data[i + 2], data[i + 3]});
         }
     }
 
-    // exchange and create
-    for (int i = 0; i < partners_size; ++i)
+    // Optional: Method to display the graph (for debugging or visualization purposes)
+    void displayGraph()
     {
-        CAG received_cag = cag.sendAndReceive(partners[i]);
+        compact();
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
+        {
+            std::cout << "Node " << nodes[slot].id << ": ";
+            for (VertexId neighbor : neighbors(slot))
+            {
+                std::cout << neighbor << " ";
+            }
+            std::cout << std::endl;
+        }
+    }
 
-        // merge received_cag into cag
-        for (const auto &nodePair : received_cag.nodes)
+    /*
+    adds the nodes and edges of (a chunk of) a received CAG, read record by record straight from the wire buffer, so the
+    partner's CAG is never built. edges only go to pending_edges and are resolved in the next compact(), so an edge may
+    reach a node of a chunk that has not been merged yet. local_ids, if given, collects the ids of the local records.
+    */
+    template <typename Records>
+    void mergeRecords(Records &records, std::vector<VertexId> *local_ids = NULL)
+    {
+        NodeRecord<VertexId> new_cag_node;
+        while (records.next(new_cag_node))
         {
-            const CAG::Node &new_cag_node = nodePair.second;
+            if (local_ids != NULL && !new_cag_node.isForeign)
+            {
+                local_ids->push_back(new_cag_node.id);
+            }
 
-            int union_find_node_id = cag.find(new_cag_node.id);
+            VertexId union_find_node_id = find(new_cag_node.id);
 
             // Add node
-            if (!cag.doesNodeExist(union_find_node_id))
+            if (!doesNodeExist(union_find_node_id))
             {
                 // node did not exist in previous cag
                 assert(union_find_node_id == new_cag_node.id);
-                cag.addNode(new_cag_node.id, new_cag_node.isForeign);
-                // cag.union_find[new_cag_node.id] = new_cag_node.id;
+                addNode(new_cag_node.id, new_cag_node.isForeign);
+                // union_find[new_cag_node.id] = new_cag_node.id;
             }
             else
             {
                 // node already existed in previous cag
-                if (cag.isNodeForeign(union_find_node_id))
+                if (isNodeForeign(union_find_node_id))
                 {
                     // node was foreign in previous cag
                     if (!new_cag_node.isForeign)
                     {
                         // node is now local in current cag
-                        cag.makeNodeLocal(new_cag_node.id);
+                        makeNodeLocal(new_cag_node.id);
                         assert(union_find_node_id == new_cag_node.id);
-                        // cag.union_find[new_cag_node.id] = new_cag_node.id;
+                        // union_find[new_cag_node.id] = new_cag_node.id;
                     }
                     else
                     {
                         // node is still foreign in current cag
-                        assert(cag.union_find.find(new_cag_node.id) == cag.union_find.end());
+                        assert(!union_find.contains(new_cag_node.id));
                         assert(union_find_node_id == new_cag_node.id);
                     }
                 }
@@ -898,117 +1395,2723 @@ int run(int mpi_rank, int mpi_size)
                 }
             }
 
-            for (int neighbor : new_cag_node.neighbors)
+            // the received runs are symmetric, so every edge is added from its smaller endpoint only
+            for (VertexId neighbor : new_cag_node.neighbors)
             {
-                cag.nodes[union_find_node_id].neighbors.insert(cag.find(neighbor));
+                if (new_cag_node.id < neighbor)
+                {
+                    linkNodes(union_find_node_id, find(neighbor));
+                }
             }
         }
+    }
+
+    /*called after all nodes of the partner's CAG, which covers [received_min, received_max], went through mergeRecords()*/
+    void completeMerge(VertexId received_min, VertexId received_max)
+    {
+        double start_time = MPI_Wtime();
+
+        // foreign nodes of the partner's range that the partner does not know anymore
+        removeForeignNodes(received_min, received_max);
+
+        // merge all local-local edges of the merged CAG
+        contractLocalToLocalEdges();
+
+        assert((local_information_id_max == received_min - 1) || (local_information_id_min == received_max + 1));
+        local_information_id_min = std::min(local_information_id_min, received_min);
+        local_information_id_max = std::max(local_information_id_max, received_max);
+
+        // every rank that knew an alias by its id is part of the merged range now
+        aliases.erase(std::remove_if(aliases.begin(), aliases.end(), [&](const Alias &alias)
+                                     { return alias.witness_min >= local_information_id_min && alias.witness_max <= local_information_id_max; }),
+                      aliases.end());
+        releaseScratch();
+        contract_seconds += MPI_Wtime() - start_time;
+    }
+
+    /*
+    receives and merges the CAG a child rank handed over with send(). returns the ids of the child's local nodes: every
+    label of the child's range resolves to one of them on the child, so that is all the child needs back.
+    */
+    std::vector<VertexId> mergeFromChild(int child_rank, WireFormat format)
+    {
+        std::vector<VertexId> child_local_ids;
+        mergeAliases(receiveBuffer<VertexId>(MPIType<VertexId>::get(), child_rank));
+        if (format == WIRE_VARINT)
+        {
+            mergeBuffer(receiveBuffer<uint8_t>(MPI_BYTE, child_rank), child_local_ids);
+        }
+        else
+        {
+            mergeBuffer(receiveBuffer<VertexId>(MPIType<VertexId>::get(), child_rank), child_local_ids);
+        }
+        return child_local_ids;
+    }
+
+    /*
+    merges the CAGs that the next ranks exported with exportTo(), in rank order, so together they cover the id range right
+    above this one. they are read in place and contracted once. the CAGs must not have been merged before, as their
+    aliases are not exported. returns the ids of the local nodes of every peer, see mergeFromChild()
+    */
+    std::vector<std::vector<VertexId>> mergeFromPeers(const std::vector<const char *> &peer_cags)
+    {
+        std::vector<std::vector<VertexId>> peer_local_ids(peer_cags.size());
+        if (peer_cags.empty())
+        {
+            return peer_local_ids;
+        }
+        VertexId received_min = 0;
+        VertexId received_max = 0;
+        for (size_t k = 0; k < peer_cags.size(); ++k)
+        {
+            ExportedRecords records(peer_cags[k]);
+            mergeRecords(records, &peer_local_ids[k]);
+            received_min = k == 0 ? records.id_min : received_min;
+            received_max = records.id_max;
+        }
+        completeMerge(received_min, received_max);
+        return peer_local_ids;
+    }
+
+    /*merges a whole CAG in the wire format T and contracts what became local, see mergeRecords()*/
+    template <typename T>
+    void mergeBuffer(std::vector<T> data, std::vector<VertexId> &local_ids)
+    {
+        auto records = recordsOf(data.data(), data.size());
+        mergeRecords(records, &local_ids);
+        // the buffer is not needed for the contraction
+        std::vector<T>().swap(data);
+        completeMerge(records.id_min, records.id_max);
+    }
+
+    /*answers a child with the current labels of the ids mergeFromChild() returned*/
+    void sendResolvedLabels(int child_rank, const std::vector<VertexId> &child_local_ids)
+    {
+        std::vector<VertexId> resolved(child_local_ids.size());
+        for (size_t k = 0; k < child_local_ids.size(); ++k)
+        {
+            resolved[k] = find(child_local_ids[k]);
+        }
+        MPI_Send(resolved.data(), resolved.size(), MPIType<VertexId>::get(), child_rank, 0, MPI_COMM_WORLD);
+    }
 
-        std::vector<int> to_remove;
-        for (const auto &nodePair : cag.nodes)
+    /*counterpart of sendResolvedLabels() on a rank whose CAG was sent to parent_rank and has not changed since*/
+    void receiveResolvedLabels(int parent_rank)
+    {
+        // the CAG is still compacted from send(), so its nodes are in the order they were serialized
+        std::vector<VertexId> resolved(nodes.size());
+        MPI_Recv(resolved.data(), resolved.size(), MPIType<VertexId>::get(), parent_rank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        size_t k = 0;
+        for (const Node &node : nodes)
         {
-            if (nodePair.first >= received_cag.local_information_id_min && nodePair.first <= received_cag.local_information_id_max && nodePair.second.isForeign)
+            if (!node.isForeign)
             {
-                to_remove.push_back(nodePair.first);
-                for (int neighbor : nodePair.second.neighbors)
+                if (resolved[k] != node.id)
                 {
-                    cag.nodes[neighbor].neighbors.erase(nodePair.first);
+                    union_find.unite(node.id, resolved[k], resolved[k]);
                 }
+                ++k;
+            }
+        }
+    }
+
+    /*swaps a buffer with partner_rank: the sizes first, then the payload*/
+    template <typename T>
+    static std::vector<T> exchangeBuffer(const std::vector<T> &data, MPI_Datatype type, int partner_rank)
+    {
+        // Exchange the size information
+        int dataSize = data.size();
+        int partnerDataSize;
+        MPI_Sendrecv(&dataSize, 1, MPI_INT, partner_rank, 0,
+                     &partnerDataSize, 1, MPI_INT, partner_rank, 0,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+        // Allocate space for the partner's data
+        std::vector<T> partnerData(partnerDataSize);
+
+        // Exchange the serialized data
+        MPI_Sendrecv(data.data(), dataSize, type, partner_rank, 0,
+                     partnerData.data(), partnerDataSize, type, partner_rank, 0,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        return partnerData;
+    }
+
+    /*receives a buffer of unknown size from source*/
+    template <typename T>
+    static std::vector<T> receiveBuffer(MPI_Datatype type, int source)
+    {
+        MPI_Status status;
+        int dataSize;
+
+        // Probe for the incoming message to find out its size
+        MPI_Probe(source, 0, MPI_COMM_WORLD, &status);
+        MPI_Get_count(&status, type, &dataSize);
+
+        std::vector<T> data(dataSize);
+        MPI_Recv(data.data(), dataSize, type, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        return data;
+    }
+
+    /*
+    exchanges the CAG with partner_rank and merges the partner's CAG into this one. the CAG is sent in chunks of whole
+    nodes of about chunk_bytes serialize() output (0: a single chunk), each chunk a complete message in the given wire
+    format. the next chunk is written and sent while the partner's previous chunk is merged, see exchangeChunksAndMerge().
+    the bytes this rank sent are added to bytes.
+    */
+    void exchangeAndMerge(int partner_rank, WireFormat format, size_t chunk_bytes, WireBytes &bytes)
+    {
+        compact();
+        bytes.raw += serializedBytes();
+
+        std::vector<VertexId> alias_data = serializeAliases();
+        bytes.raw += alias_data.size() * sizeof(VertexId);
+        bytes.encoded += alias_data.size() * sizeof(VertexId);
+        mergeAliases(exchangeBuffer(alias_data, MPIType<VertexId>::get(), partner_rank));
+
+        // the chunks are cut before the first merge, which adds nodes and pending edges
+        std::vector<size_t> bounds(1, 0);
+        size_t words = 0;
+        for (size_t slot = 0; slot < nodes.size(); ++slot)
+        {
+            words += 3 + offsets[slot + 1] - offsets[slot];
+            if (chunk_bytes > 0 && words * sizeof(VertexId) >= chunk_bytes && slot + 1 < nodes.size())
+            {
+                bounds.push_back(slot + 1);
+                words = 0;
             }
         }
-        for (int node_id : to_remove)
+        bounds.push_back(nodes.size());
+
+        if (format == WIRE_VARINT)
+        {
+            exchangeChunksAndMerge<uint8_t>(bounds, MPI_BYTE, partner_rank, bytes);
+        }
+        else
         {
-            cag.nodes.erase(node_id);
+            exchangeChunksAndMerge<VertexId>(bounds, MPIType<VertexId>::get(), partner_rank, bytes);
         }
+    }
 
-        // merge all local-local edges in the CAG of the variable cag
-        cag.contractLocalToLocalEdges();
+    /*one-sided, unchunked counterpart of exchangeAndMerge(), used to hand the CAG to a parent rank*/
+    void send(int dest, WireFormat format, WireBytes &bytes)
+    {
+        std::vector<VertexId> alias_data = serializeAliases();
+        bytes.raw += alias_data.size() * sizeof(VertexId);
+        bytes.encoded += alias_data.size() * sizeof(VertexId);
+        MPI_Send(alias_data.data(), alias_data.size(), MPIType<VertexId>::get(), dest, 0, MPI_COMM_WORLD);
 
-        assert((cag.local_information_id_max == received_cag.local_information_id_min - 1) || (cag.local_information_id_min == received_cag.local_information_id_max + 1));
-        cag.local_information_id_min = std::min(cag.local_information_id_min, received_cag.local_information_id_min);
-        cag.local_information_id_max = std::max(cag.local_information_id_max, received_cag.local_information_id_max);
+        bytes.raw += serializedBytes();
+        if (format == WIRE_VARINT)
+        {
+            std::vector<uint8_t> encodedData = encode();
+            bytes.encoded += encodedData.size();
+            MPI_Send(encodedData.data(), encodedData.size(), MPI_BYTE, dest, 0, MPI_COMM_WORLD);
+        }
+        else
+        {
+            std::vector<VertexId> serializedData = serialize();
+            bytes.encoded += serializedData.size() * sizeof(VertexId);
+            MPI_Send(serializedData.data(), serializedData.size(), MPIType<VertexId>::get(), dest, 0, MPI_COMM_WORLD);
+        }
     }
+};
 
-    for (size_t i = 0; i < labels.size(); ++i)
+/*
+read-only memory mapping of a graph file in the binary CSR format written by "convert --format=csr":
+
+    page 0          header: the magic "CCCSR1", the byte widths of vertex ids and offsets, vertices, edges and the
+                    positions of both arrays
+    offsets         vertices + 1 offsets into targets, starting on a page boundary
+    targets         the neighbors of all vertices, starting on a page boundary
+
+all ranks of a node map the same file, so they share its pages in the page cache, and a Graph only points into its
+slice of the arrays instead of copying it.
+*/
+class MappedGraph
+{
+private:
+    struct Header
     {
-        int label = labels[i];
-        bool had_to_do_it = false;
-        while (label != cag.union_find[label])
+        char magic[8];
+        uint32_t vertex_id_bytes;
+        uint32_t edge_offset_bytes;
+        uint64_t vertices;
+        uint64_t edges;
+        uint64_t offsets_position;
+        uint64_t targets_position;
+    };
+
+    void *address;
+    size_t length;
+    Header header;
+
+public:
+    static const char *magic() { return "CCCSR1"; }
+
+    /*true if path starts with the magic of the format*/
+    static bool matches(const std::string &path)
+    {
+        char buffer[8] = {0};
+        std::ifstream in(path, std::ios::binary);
+        in.read(buffer, sizeof(buffer));
+        return in && std::string(buffer) == magic();
+    }
+
+    MappedGraph(const std::string &path)
+    {
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0)
         {
-            label = cag.union_find[label];
-            had_to_do_it = true;
+            throw std::runtime_error("Could not open " + path);
         }
-        if (had_to_do_it)
+        struct stat status;
+        fstat(descriptor, &status);
+        length = status.st_size;
+        address = length < sizeof(Header) ? MAP_FAILED : mmap(NULL, length, PROT_READ, MAP_SHARED, descriptor, 0);
+        close(descriptor);
+        if (address == MAP_FAILED)
         {
-            cag.union_find[labels[i]] = label;
+            throw std::runtime_error("Could not map " + path);
         }
 
-        labels[i] = label;
+        std::copy(static_cast<const char *>(address), static_cast<const char *>(address) + sizeof(Header), reinterpret_cast<char *>(&header));
+        if (std::string(header.magic) != magic() ||
+            header.offsets_position + (header.vertices + 1) * header.edge_offset_bytes > length ||
+            header.targets_position + header.edges * header.vertex_id_bytes > length)
+        {
+            munmap(address, length);
+            throw std::runtime_error(path + " is not a valid CSR graph file");
+        }
     }
 
-    if (COUNT_CC)
+    ~MappedGraph()
+    {
+        munmap(address, length);
+    }
+
+    MappedGraph(const MappedGraph &) = delete;
+    MappedGraph &operator=(const MappedGraph &) = delete;
+
+    long long vertices() const { return header.vertices; }
+    long long edges() const { return header.edges; }
+
+    /*the arrays as VertexId / EdgeOffset, which have to have the widths the file was written with*/
+    template <typename VertexId, typename EdgeOffset>
+    const EdgeOffset *offsets() const
     {
-        std::unordered_set<int> unique_labels(labels.begin(), labels.end());
-        // send labels to rank 0
-        if (mpi_rank != 0)
+        if (header.vertex_id_bytes != sizeof(VertexId) || header.edge_offset_bytes != sizeof(EdgeOffset))
         {
-            std::vector<int> labels_to_send;
-            for (int label : unique_labels)
-            {
-                labels_to_send.push_back(label);
-            }
-            int labels_to_send_size = labels_to_send.size();
-            MPI_Send(&labels_to_send_size, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
-            MPI_Send(labels_to_send.data(), labels_to_send_size, MPI_INT, 0, 0, MPI_COMM_WORLD);
+            throw std::runtime_error("The CSR file has " + std::to_string(header.vertex_id_bytes * 8) + " bit ids and " +
+                                     std::to_string(header.edge_offset_bytes * 8) + " bit offsets, build with these VERTEX_ID_BITS and EDGE_OFFSET_BITS or convert with --vertex-id-bits and --edge-offset-bits");
         }
-        else
+        return reinterpret_cast<const EdgeOffset *>(static_cast<const char *>(address) + header.offsets_position);
+    }
+
+    template <typename VertexId, typename EdgeOffset>
+    const VertexId *targets() const
+    {
+        offsets<VertexId, EdgeOffset>(); // checks the widths
+        return reinterpret_cast<const VertexId *>(static_cast<const char *>(address) + header.targets_position);
+    }
+};
+
+/// @brief CSR adjacency of a contiguous range of vertices. EdgeOffset is the integer type of the offsets into targets
+template <typename VertexId, typename EdgeOffset>
+class Graph
+{
+private:
+    void DFS(VertexId v, std::vector<bool> &visited, VertexId label, std::vector<VertexId> &components)
+    {
+        std::stack<VertexId> stack;
+        stack.push(v);
+
+        while (!stack.empty())
         {
-            for (int i = 1; i < mpi_size; ++i)
+            v = stack.top();
+            stack.pop();
+
+            if (!visited[v - startVertexIndex])
             {
-                int labels_to_receive_size;
-                MPI_Recv(&labels_to_receive_size, 1, MPI_INT, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                std::vector<int> labels_to_receive(labels_to_receive_size);
-                MPI_Recv(labels_to_receive.data(), labels_to_receive_size, MPI_INT, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                for (int label : labels_to_receive)
+                visited[v - startVertexIndex] = true;
+                components[v - startVertexIndex] = label;
+
+                for (VertexId i : (this->operator[](v)))
                 {
-                    unique_labels.insert(label);
+                    if (i >= startVertexIndex && i < startVertexIndex + vertexCount && !visited[i - startVertexIndex])
+                    {
+                        stack.push(i);
+                    }
+                    else if (i < startVertexIndex || i >= startVertexIndex + vertexCount)
+                    {
+                        foreign_to_local_edges[i].push_back(v);
+                        local_to_foreign_nodes[v].push_back(i);
+                    }
                 }
             }
-            std::cout << std::endl
-                      << "Number of connected components: " << unique_labels.size() << std::endl;
         }
     }
-    return 0;
-}
 
-int main(int argc, char **argv)
-{
-    MPI_Init(&argc, &argv);
+public:
+    // Read-only view of the neighbors of one vertex (a slice of targets).
+    typedef IdRange<VertexId> Neighbors;
+
+    VertexId startVertexIndex;
+    VertexId vertexCount;
+    // CSR adjacency: the neighbors of vertex startVertexIndex + i are targets[offsets[i]] .. targets[offsets[i + 1] - 1]
+    std::vector<EdgeOffset> offsets;
+    std::vector<VertexId> targets;
+    // a graph created by fromMapping() leaves offsets and targets empty and reads its slice of the mapped file instead.
+    // everything that reads the adjacency goes through offsetData() and targetData().
+    std::shared_ptr<const MappedGraph> mapping;
+    const EdgeOffset *mapped_offsets = nullptr;
+    const VertexId *mapped_targets = nullptr;
+    std::unordered_map<VertexId, std::vector<VertexId>> foreign_to_local_edges;
+    std::unordered_map<VertexId, std::vector<VertexId>> local_to_foreign_nodes;
 
-    int mpi_rank;
-    int mpi_size;
-    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
-    int status;
-    double commulative_time = 0;
-    int runs = 0;
-    do
+    /*default constructor*/
+    Graph() : startVertexIndex(0), vertexCount(0), offsets(1, 0) {}
+    /*complete graph without edges*/
+    Graph(VertexId vertexCount) : startVertexIndex(0), vertexCount(vertexCount), offsets(vertexCount + 1, 0) {}
+    /*subgraph without edges*/
+    Graph(VertexId vertexCount, VertexId startVertexIndex) : startVertexIndex(startVertexIndex), vertexCount(vertexCount), offsets(vertexCount + 1, 0) {}
+
+    /*builds the CSR arrays from a list of (v, w) pairs with absolute positions. every v has to be inside the range of the graph.*/
+    static Graph fromEdges(VertexId vertexCount, VertexId startVertexIndex, const std::vector<std::pair<VertexId, VertexId>> &edges, bool directed)
     {
-        runs++;
-        double start_time = MPI_Wtime();
+        Graph g(vertexCount, startVertexIndex);
+
+        // count degrees, then turn the counts into offsets
+        for (const auto &edge : edges)
+        {
+            g.checkVertex(edge.first);
+            g.offsets[edge.first - startVertexIndex + 1]++;
+            if (!directed)
+            {
+                g.checkVertex(edge.second);
+                g.offsets[edge.second - startVertexIndex + 1]++;
+            }
+        }
+        for (VertexId i = 0; i < vertexCount; ++i)
+        {
+            g.offsets[i + 1] += g.offsets[i];
+        }
 
-        status = run(mpi_rank, mpi_size);
+        g.targets.resize(g.offsets[vertexCount]);
+        std::vector<EdgeOffset> fill(g.offsets.begin(), g.offsets.end() - 1);
+        for (const auto &edge : edges)
+        {
+            g.targets[fill[edge.first - startVertexIndex]++] = edge.second;
+            if (!directed)
+            {
+                g.targets[fill[edge.second - startVertexIndex]++] = edge.first;
+            }
+        }
+        return g;
+    }
 
-        status = 1;
+    /*view of the vertices [startVertexIndex, startVertexIndex + vertexCount) of a mapped file, without copying*/
+    static Graph fromMapping(const std::shared_ptr<const MappedGraph> &mapping, VertexId vertexCount, VertexId startVertexIndex)
+    {
+        Graph g;
+        g.startVertexIndex = startVertexIndex;
+        g.vertexCount = vertexCount;
+        g.offsets.clear();
+        g.mapping = mapping;
+        // the offsets of the slice stay absolute, so they index the targets of the whole file
+        g.mapped_offsets = mapping->offsets<VertexId, EdgeOffset>() + startVertexIndex;
+        g.mapped_targets = mapping->targets<VertexId, EdgeOffset>();
+        return g;
+    }
 
-        double end_time = MPI_Wtime();
-        commulative_time += end_time - start_time;
-        if (mpi_rank == 0)
+    const EdgeOffset *offsetData() const
+    {
+        return mapping ? mapped_offsets : offsets.data();
+    }
+
+    const VertexId *targetData() const
+    {
+        return mapping ? mapped_targets : targets.data();
+    }
+
+    /*amount of adjacency entries of the range*/
+    size_t edgeCount() const
+    {
+        return offsetData()[vertexCount] - offsetData()[0];
+    }
+
+    void checkVertex(size_t index) const
+    {
+        // Adjust index by the offset.
+        size_t adjustedIndex = index - startVertexIndex;
+
+        // Check for out-of-bounds access.
+        if (adjustedIndex >= static_cast<size_t>(vertexCount))
         {
-            std::cout << "time taken: " << end_time - start_time << ", average time: " << commulative_time / runs << std::endl
-                      << std::endl;
+            throw std::out_of_range("Index out of range");
+        }
+    }
+
+    // Overload the subscript operator to provide the desired offset functionality.
+    Neighbors operator[](size_t index) const
+    {
+        checkVertex(index);
+        size_t adjustedIndex = index - startVertexIndex;
+        const VertexId *base = targetData();
+        const EdgeOffset *offsets = offsetData();
+        return Neighbors{base + offsets[adjustedIndex], base + offsets[adjustedIndex + 1]};
+    }
+
+    /*prints the current graph*/
+    void print() const
+    {
+        for (VertexId i = 0; i < vertexCount; ++i)
+        {
+            std::cout << i + startVertexIndex << ": ";
+            for (VertexId w : this->operator[](i + startVertexIndex))
+            {
+                std::cout << w << " ";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    void printWithDashes() const
+    {
+        for (VertexId i = 0; i < vertexCount; ++i)
+        {
+            for (VertexId w : this->operator[](i + startVertexIndex))
+            {
+                if (i + startVertexIndex <= w)
+                    std::cout << i + startVertexIndex << "-" << w << std::endl;
+            }
+        }
+    }
+
+    /*vertices contain vertex ids (absolute). "from" and "to" are the ids of the specified range of vertices (including "to").*/
+    void sendSubgraph(int dest, VertexId from, VertexId to, MPI_Comm comm)
+    {
+        if (from < startVertexIndex || to >= startVertexIndex + vertexCount || from > to)
+        {
+            throw std::out_of_range("vertices contains an invalid vertex id");
+        }
+
+        VertexId size = to - from + 1;
+        const EdgeOffset *offsets = offsetData();
+        EdgeOffset firstEdge = offsets[from - startVertexIndex];
+        EdgeOffset edgeCount = offsets[to - startVertexIndex + 1] - firstEdge;
+
+        // Rebase the offsets of the range so that they start at 0
+        std::vector<EdgeOffset> rangeOffsets(size + 1);
+        for (VertexId i = 0; i <= size; ++i)
+        {
+            rangeOffsets[i] = offsets[from - startVertexIndex + i] - firstEdge;
         }
-    } while (false);
+
+        // Calculate the size of the buffer: size, from, offsets and targets
+        int bufferSize = sizeof(VertexId) * (2 + edgeCount) + sizeof(EdgeOffset) * (size + 1);
+
+        // Allocate the buffer
+        char *buffer = new char[bufferSize];
+        int position = 0;
+
+        // Pack the data into the buffer
+        MPI_Pack(&size, 1, MPIType<VertexId>::get(), buffer, bufferSize, &position, comm);
+        MPI_Pack(&from, 1, MPIType<VertexId>::get(), buffer, bufferSize, &position, comm);
+        MPI_Pack(rangeOffsets.data(), size + 1, MPIType<EdgeOffset>::get(), buffer, bufferSize, &position, comm);
+        MPI_Pack(targetData() + firstEdge, edgeCount, MPIType<VertexId>::get(), buffer, bufferSize, &position, comm);
+
+        // Send the buffer
+        MPI_Send(buffer, position, MPI_PACKED, dest, 0, comm);
+
+        // Free the buffer
+        delete[] buffer;
+    }
+
+    /*receives a graph*/
+    static Graph receiveSubgraph(int source, MPI_Comm comm)
+    {
+        MPI_Status status;
+        int bufferSize;
+
+        // Probe for the incoming message to find out its size
+        MPI_Probe(source, 0, comm, &status);
+        MPI_Get_count(&status, MPI_PACKED, &bufferSize);
+
+        // Allocate a buffer to receive the data
+        char *buffer = new char[bufferSize];
+        MPI_Recv(buffer, bufferSize, MPI_PACKED, source, 0, comm, &status);
+
+        // Unpack the buffer
+        int position = 0;
+        VertexId size;
+        VertexId rec_startVertexIndex;
+
+        MPI_Unpack(buffer, bufferSize, &position, &size, 1, MPIType<VertexId>::get(), comm);
+        MPI_Unpack(buffer, bufferSize, &position, &rec_startVertexIndex, 1, MPIType<VertexId>::get(), comm);
+        Graph subgraph(size, rec_startVertexIndex);
+        MPI_Unpack(buffer, bufferSize, &position, subgraph.offsets.data(), size + 1, MPIType<EdgeOffset>::get(), comm);
+        subgraph.targets.resize(subgraph.offsets[size]);
+        MPI_Unpack(buffer, bufferSize, &position, subgraph.targets.data(), subgraph.offsets[size], MPIType<VertexId>::get(), comm);
+
+        // Free the buffer
+        delete[] buffer;
+        return subgraph;
+    }
+
+    /*creates a subgraph. "from" and "to" are the ids of the specified range of vertices (including "to").*/
+    Graph createSubgraph(VertexId from, VertexId to) const
+    {
+        if (from < startVertexIndex || to >= startVertexIndex + vertexCount || from > to)
+        {
+            throw std::out_of_range("Invalid range for subgraph creation");
+        }
+
+        VertexId subgraphVertexCount = to - from + 1;
+        Graph subgraph(subgraphVertexCount, from);
+
+        // The range is a contiguous slice of the CSR arrays
+        const EdgeOffset *offsets = offsetData();
+        EdgeOffset firstEdge = offsets[from - startVertexIndex];
+        EdgeOffset lastEdge = offsets[to - startVertexIndex + 1];
+        for (VertexId i = 0; i <= subgraphVertexCount; ++i)
+        {
+            subgraph.offsets[i] = offsets[from - startVertexIndex + i] - firstEdge;
+        }
+        subgraph.targets.assign(targetData() + firstEdge, targetData() + lastEdge);
+
+        return subgraph;
+    }
+
+    /*
+    returns a vector containing the labels of vertices in the graph. ret[i-startVertexIndex] is label of vertex with id i.
+    labels are unique per component and lie in [startVertexIndex, startVertexIndex + vertexCount), which is all that
+    createCAG() and the reduction tree rely on. with more than one thread connectedComponentsParallel() is used.
+    */
+    std::vector<VertexId> connectedComponents(int threads = 1)
+    {
+        if (threads > 1)
+        {
+            return connectedComponentsParallel(threads);
+        }
+
+        std::vector<bool> visited(vertexCount, false);
+        std::vector<VertexId> components(vertexCount, -1); // -1 means unvisited
+        VertexId label = startVertexIndex;
+
+        for (VertexId v = startVertexIndex; v < startVertexIndex + vertexCount; ++v)
+        {
+            if (!visited[v - startVertexIndex])
+            {
+                DFS(v, visited, label, components);
+                label++; // Increment label for next component
+            }
+        }
+        return components;
+    }
+
+    /*
+    the threads hook the local edges of their block of vertices into a lock-free union-find: the larger of two roots is
+    linked below the smaller one with a CAS, so parents only ever decrease and every root is the smallest vertex of its
+    component. that vertex is the label. border edges are collected per thread and entered into
+    foreign_to_local_edges / local_to_foreign_nodes afterwards.
+    */
+    std::vector<VertexId> connectedComponentsParallel(int threads)
+    {
+        const EdgeOffset *offsets = offsetData();
+        const VertexId *targets = targetData();
+        std::vector<std::atomic<VertexId>> parent(vertexCount);
+        std::vector<std::vector<std::pair<VertexId, VertexId>>> border_edges(threads); // (local, foreign)
+
+        auto find = [&parent](VertexId x)
+        {
+            while (true)
+            {
+                VertexId p = parent[x].load(std::memory_order_relaxed);
+                if (p == x)
+                {
+                    return x;
+                }
+                VertexId grandparent = parent[p].load(std::memory_order_relaxed);
+                if (grandparent != p)
+                {
+                    parent[x].compare_exchange_weak(p, grandparent, std::memory_order_relaxed); // path halving
+                }
+                x = grandparent;
+            }
+        };
+
+        parallelBlocks(threads, vertexCount, [&](size_t begin, size_t end, int t)
+                       {
+            for (size_t i = begin; i < end; ++i)
+            {
+                parent[i].store(i, std::memory_order_relaxed);
+            } });
+
+        parallelBlocks(threads, vertexCount, [&](size_t begin, size_t end, int t)
+                       {
+            for (size_t i = begin; i < end; ++i)
+            {
+                for (EdgeOffset e = offsets[i]; e < offsets[i + 1]; ++e)
+                {
+                    VertexId j = targets[e];
+                    if (j < startVertexIndex || j >= startVertexIndex + vertexCount)
+                    {
+                        border_edges[t].emplace_back(startVertexIndex + i, j);
+                        continue;
+                    }
+
+                    VertexId u = i;
+                    VertexId v = j - startVertexIndex;
+                    while (true)
+                    {
+                        u = find(u);
+                        v = find(v);
+                        if (u == v)
+                        {
+                            break;
+                        }
+                        if (u > v)
+                        {
+                            std::swap(u, v);
+                        }
+                        VertexId expected = v;
+                        if (parent[v].compare_exchange_strong(expected, u, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                }
+            } });
+
+        std::vector<VertexId> components(vertexCount);
+        parallelBlocks(threads, vertexCount, [&](size_t begin, size_t end, int t)
+                       {
+            for (size_t i = begin; i < end; ++i)
+            {
+                components[i] = startVertexIndex + find(i);
+            } });
+
+        for (const std::vector<std::pair<VertexId, VertexId>> &edges : border_edges)
+        {
+            for (const std::pair<VertexId, VertexId> &edge : edges)
+            {
+                foreign_to_local_edges[edge.second].push_back(edge.first);
+                local_to_foreign_nodes[edge.first].push_back(edge.second);
+            }
+        }
+        return components;
+    }
+
+    CAG<VertexId> createCAG(std::vector<VertexId> &connectedComponents, std::unordered_map<VertexId, VertexId> &foreign_ID_to_label) const
+    {
+        const EdgeOffset *offsets = offsetData();
+        const VertexId *targets = targetData();
+        CAG<VertexId> cag;
+        for (VertexId i = 0; i < vertexCount; ++i)
+        {
+            for (EdgeOffset e = offsets[i]; e < offsets[i + 1]; ++e)
+            {
+                VertexId j = targets[e];
+                // vertex i is connected to vertex j
+                if (j < startVertexIndex || j >= startVertexIndex + vertexCount)
+                { // j is a foreign node
+                    cag.addEdgeLocalToForeign(connectedComponents[i], foreign_ID_to_label[j]);
+                }
+            }
+        }
+        return cag;
+    }
+};
+
+template <typename VertexId, typename EdgeOffset>
+Graph<VertexId, EdgeOffset> generateRandomGraph(VertexId num_nodes, EdgeOffset num_edges)
+{
+    std::vector<std::pair<VertexId, VertexId>> edges;
+    edges.reserve(num_edges);
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<VertexId> distrib(0, num_nodes - 1);
+
+    for (EdgeOffset i = 0; i < num_edges; ++i)
+    {
+        VertexId u = distrib(gen);
+        VertexId v = distrib(gen);
+        if (u == v)
+        {
+            --i;
+            continue;
+        }
+        edges.emplace_back(u, v);
+    }
+
+    return Graph<VertexId, EdgeOffset>::fromEdges(num_nodes, 0, edges, false);
+}
+
+/*
+read access to the datasets of an HDF5 graph file. this uses the C API of HDF5 since parallel builds of HDF5 come
+without the C++ API. when compiled with PARALLEL_HDF5 the file is opened through MPI-IO and every read is collective,
+so all ranks of comm have to issue the same sequence of reads (possibly with empty selections).
+*/
+class HDF5Reader
+{
+private:
+    hid_t file;
+    hid_t transfer;
+
+    static void check(long long status, const std::string &what)
+    {
+        if (status < 0)
+        {
+            throw std::runtime_error("HDF5 error: " + what);
+        }
+    }
+
+public:
+    long long bytes_read = 0;
+    double read_seconds = 0;
+
+    /*comm is only used by the parallel build, which opens the file collectively on comm*/
+    HDF5Reader(const std::string &path, MPI_Comm comm)
+    {
+        hid_t access = H5Pcreate(H5P_FILE_ACCESS);
+#ifdef PARALLEL_HDF5
+        if (H5Pset_fapl_mpio(access, comm, MPI_INFO_NULL) < 0 || H5Pset_all_coll_metadata_ops(access, true) < 0)
+        {
+            H5Pclose(access);
+            throw std::runtime_error("HDF5 error: could not set MPI-IO file access");
+        }
+#else
+        (void)comm;
+#endif
+        double start_time = MPI_Wtime();
+        file = H5Fopen(path.c_str(), H5F_ACC_RDONLY, access);
+        read_seconds += MPI_Wtime() - start_time;
+        H5Pclose(access);
+        check(file, "could not open " + path);
+
+        // created only once the file is open, so a failed open leaks nothing
+        transfer = H5Pcreate(H5P_DATASET_XFER);
+#ifdef PARALLEL_HDF5
+        if (H5Pset_dxpl_mpio(transfer, H5FD_MPIO_COLLECTIVE) < 0)
+        {
+            H5Pclose(transfer);
+            H5Fclose(file);
+            throw std::runtime_error("HDF5 error: could not set collective transfer");
+        }
+#endif
+    }
+
+    ~HDF5Reader()
+    {
+        H5Pclose(transfer);
+        H5Fclose(file);
+    }
+
+    HDF5Reader(const HDF5Reader &) = delete;
+    HDF5Reader &operator=(const HDF5Reader &) = delete;
+
+    /*reads a scalar integer dataset*/
+    template <typename T>
+    T readScalar(const std::string &name)
+    {
+        double start_time = MPI_Wtime();
+        hid_t dataset = H5Dopen(file, name.c_str(), H5P_DEFAULT);
+        check(dataset, "could not open dataset " + name);
+
+        T value;
+        herr_t status = H5Dread(dataset, HDF5Type<T>::get(), H5S_ALL, H5S_ALL, transfer, &value);
+        H5Dclose(dataset);
+        check(status, "could not read dataset " + name);
+        read_seconds += MPI_Wtime() - start_time;
+        bytes_read += sizeof(T);
+        return value;
+    }
+
+    /*returns the amount of rows of a dataset*/
+    hsize_t rowCount(const std::string &name)
+    {
+        hid_t dataset = H5Dopen(file, name.c_str(), H5P_DEFAULT);
+        check(dataset, "could not open dataset " + name);
+        hid_t dataspace = H5Dget_space(dataset);
+        hsize_t dims[2] = {0, 1};
+        H5Sget_simple_extent_dims(dataspace, dims, NULL);
+        H5Sclose(dataspace);
+        H5Dclose(dataset);
+        return dims[0];
+    }
+
+    /*reads the rows firstRow..firstRow+rows-1 of a one or two dimensional integer dataset into buffer*/
+    template <typename T>
+    void readRows(const std::string &name, hsize_t firstRow, hsize_t rows, T *buffer)
+    {
+        double start_time = MPI_Wtime();
+        hid_t dataset = H5Dopen(file, name.c_str(), H5P_DEFAULT);
+        check(dataset, "could not open dataset " + name);
+        hid_t dataspace = H5Dget_space(dataset);
+
+        hsize_t dims[2] = {0, 1};
+        int rank = H5Sget_simple_extent_dims(dataspace, dims, NULL);
+        hsize_t count[2] = {rows, dims[1]};
+        hsize_t offset[2] = {firstRow, 0};
+
+        hsize_t memDims[2] = {std::max<hsize_t>(rows, 1), dims[1]};
+        hid_t memspace = H5Screate_simple(rank, memDims, NULL);
+        if (rows == 0)
+        {
+            // collective reads need every rank to take part, even without data
+            H5Sselect_none(dataspace);
+            H5Sselect_none(memspace);
+        }
+        else
+        {
+            H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, offset, NULL, count, NULL);
+        }
+
+        herr_t status = H5Dread(dataset, HDF5Type<T>::get(), memspace, dataspace, transfer, buffer);
+        H5Sclose(memspace);
+        H5Sclose(dataspace);
+        H5Dclose(dataset);
+        check(status, "could not read dataset " + name);
+        read_seconds += MPI_Wtime() - start_time;
+        bytes_read += rows * dims[1] * sizeof(T);
+    }
+};
+
+/*
+write access for the results. with PARALLEL_HDF5 all ranks of comm create the file together and every write is a
+collective hyperslab write. the serial HDF5 library cannot share a file between processes, so there rank 0 creates
+the file and every write is done by one rank after the other, each opening and closing the file on its own.
+*/
+class HDF5Writer
+{
+private:
+    std::string path;
+    MPI_Comm comm;
+    int rank;
+    int size;
+    hid_t file; // only open for the whole lifetime with PARALLEL_HDF5
+    hid_t transfer;
+
+    static void check(long long status, const std::string &what)
+    {
+        if (status < 0)
+        {
+            throw std::runtime_error("HDF5 error: " + what);
+        }
+    }
+
+    /*writes rows firstRow..firstRow+rows-1 of the dataset name of target, which is created first if create is set*/
+    template <typename T>
+    void writeSlice(hid_t target, bool create, const std::string &name, hsize_t totalRows, hsize_t columns, hsize_t firstRow, hsize_t rows, const T *buffer)
+    {
+        int dims_rank = columns == 1 ? 1 : 2;
+        hsize_t dims[2] = {totalRows, columns};
+        hid_t dataspace = H5Screate_simple(dims_rank, dims, NULL);
+        hid_t dataset = create ? H5Dcreate(target, name.c_str(), HDF5Type<T>::get(), dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)
+                               : H5Dopen(target, name.c_str(), H5P_DEFAULT);
+        check(dataset, "could not create dataset " + name);
+
+        hsize_t count[2] = {rows, columns};
+        hsize_t offset[2] = {firstRow, 0};
+        hsize_t memDims[2] = {std::max<hsize_t>(rows, 1), columns};
+        hid_t memspace = H5Screate_simple(dims_rank, memDims, NULL);
+        if (rows == 0)
+        {
+            // collective writes need every rank to take part, even without data
+            H5Sselect_none(dataspace);
+            H5Sselect_none(memspace);
+        }
+        else
+        {
+            H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, offset, NULL, count, NULL);
+        }
+
+        herr_t status = H5Dwrite(dataset, HDF5Type<T>::get(), memspace, dataspace, transfer, buffer);
+        H5Sclose(memspace);
+        H5Sclose(dataspace);
+        H5Dclose(dataset);
+        check(status, "could not write dataset " + name);
+    }
+
+public:
+    long long bytes_written = 0;
+    double write_seconds = 0;
+
+    HDF5Writer(const std::string &path, MPI_Comm comm) : path(path), comm(comm), file(-1)
+    {
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+        double start_time = MPI_Wtime();
+#ifdef PARALLEL_HDF5
+        hid_t access = H5Pcreate(H5P_FILE_ACCESS);
+        if (H5Pset_fapl_mpio(access, comm, MPI_INFO_NULL) < 0)
+        {
+            H5Pclose(access);
+            throw std::runtime_error("HDF5 error: could not set MPI-IO file access");
+        }
+        file = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, access);
+        H5Pclose(access);
+        check(file, "could not create " + path);
+#else
+        if (rank == 0)
+        {
+            hid_t created = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+            check(created, "could not create " + path);
+            H5Fclose(created);
+        }
+        MPI_Barrier(comm);
+#endif
+        write_seconds += MPI_Wtime() - start_time;
+
+        // created only once the file exists, so a failed create leaks nothing
+        transfer = H5Pcreate(H5P_DATASET_XFER);
+#ifdef PARALLEL_HDF5
+        if (H5Pset_dxpl_mpio(transfer, H5FD_MPIO_COLLECTIVE) < 0)
+        {
+            H5Pclose(transfer);
+            H5Fclose(file);
+            throw std::runtime_error("HDF5 error: could not set collective transfer");
+        }
+#endif
+    }
+
+    ~HDF5Writer()
+    {
+        H5Pclose(transfer);
+        if (file >= 0)
+        {
+            H5Fclose(file);
+        }
+    }
+
+    HDF5Writer(const HDF5Writer &) = delete;
+    HDF5Writer &operator=(const HDF5Writer &) = delete;
+
+    /*
+    creates the integer dataset name with totalRows rows of columns values (one dimensional if columns is 1) and writes
+    the rows firstRow..firstRow+rows-1 of this rank from buffer. all ranks of comm have to call this together.
+    */
+    template <typename T>
+    void writeRows(const std::string &name, hsize_t totalRows, hsize_t columns, hsize_t firstRow, hsize_t rows, const T *buffer)
+    {
+        double start_time = MPI_Wtime();
+#ifdef PARALLEL_HDF5
+        writeSlice(file, true, name, totalRows, columns, firstRow, rows, buffer);
+#else
+        // one rank after the other, rank 0 creates the dataset
+        if (rank > 0)
+        {
+            MPI_Recv(NULL, 0, MPI_INT, rank - 1, 0, comm, MPI_STATUS_IGNORE);
+        }
+        hid_t opened = H5Fopen(path.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+        check(opened, "could not open " + path);
+        writeSlice(opened, rank == 0, name, totalRows, columns, firstRow, rows, buffer);
+        H5Fclose(opened);
+        if (rank + 1 < size)
+        {
+            MPI_Send(NULL, 0, MPI_INT, rank + 1, 0, comm);
+        }
+        MPI_Barrier(comm);
+#endif
+        write_seconds += MPI_Wtime() - start_time;
+        bytes_written += rows * columns * sizeof(T);
+    }
+};
+
+// Function to read the 'vertices' integer from an opened HDF5 file
+template <typename VertexId, typename EdgeOffset>
+VertexId readVerticesFromHDF5File(HDF5Reader &file)
+{
+    // the datasets are converted to VertexId/EdgeOffset while reading, so make sure they fit
+    long long vertices = file.readScalar<long long>("vertices");
+    if (vertices > std::numeric_limits<VertexId>::max())
+    {
+        throw std::runtime_error("Graph has more vertices than VertexId can hold, build with VERTEX_ID_BITS=64");
+    }
+    if (file.rowCount("data") > static_cast<hsize_t>(std::numeric_limits<EdgeOffset>::max()))
+    {
+        throw std::runtime_error("Graph has more entries than EdgeOffset can hold, build with EDGE_OFFSET_BITS=64");
+    }
+    return vertices;
+}
+
+/*reads the lines startLine..endLine (including endLine) of the list format straight into the CSR arrays of a subgraph*/
+template <typename VertexId, typename EdgeOffset>
+Graph<VertexId, EdgeOffset> readSubgraphFromHDF5(HDF5Reader &file, VertexId startLine, VertexId endLine)
+{
+    Graph<VertexId, EdgeOffset> subgraph(endLine - startLine + 1, startLine);
+
+    // Read the lookup indices for the start and end lines
+    std::vector<EdgeOffset> lookup(subgraph.vertexCount * 2); // Buffer for lookup indices
+    file.readRows("lookup", startLine, subgraph.vertexCount, lookup.data());
+
+    EdgeOffset startIdx = lookup[0];
+    EdgeOffset endIdx = lookup[(endLine - startLine) * 2 + 1]; // End index of endLine
+
+    // Every line is "vertex neighbors... -1", so it holds end - start - 1 neighbors
+    for (VertexId i = 0; i < subgraph.vertexCount; ++i)
+    {
+        subgraph.offsets[i + 1] = subgraph.offsets[i] + lookup[i * 2 + 1] - lookup[i * 2] - 1;
+    }
+    lookup = std::vector<EdgeOffset>();
+
+    // Read the data chunk directly into the targets array
+    std::vector<VertexId> &chunk = subgraph.targets;
+    chunk.resize(endIdx - startIdx + 1);
+    file.readRows("data", startIdx, chunk.size(), chunk.data());
+
+    // Compact the chunk in place by dropping the leading vertex id and the -1 separator of every line
+    size_t read = 0;
+    for (VertexId i = 0; i < subgraph.vertexCount; ++i)
+    {
+        VertexId should_be = startLine + i;
+        if (chunk[read] != should_be)
+        {
+            std::cout << "Error: " << chunk[read] << " should be " << should_be << std::endl;
+            throw std::runtime_error("Error: file vertice at line " + std::to_string(chunk[read]) + " should be " + std::to_string(should_be));
+        }
+        read++;
+
+        for (EdgeOffset write = subgraph.offsets[i]; write < subgraph.offsets[i + 1]; ++write)
+        {
+            chunk[write] = chunk[read++];
+        }
+
+        if (chunk[read++] != -1)
+        {
+            throw std::runtime_error("Error: line of vertice " + std::to_string(should_be) + " is not terminated by -1");
+        }
+    }
+    chunk.resize(subgraph.offsets[subgraph.vertexCount]);
+
+    return subgraph;
+}
+
+/*reads the amount of neighbors of the lines startLine..endLine (including endLine) from the lookup dataset*/
+template <typename VertexId, typename EdgeOffset>
+std::vector<EdgeOffset> readDegreesFromHDF5(HDF5Reader &file, VertexId startLine, VertexId endLine)
+{
+    hsize_t count[1] = {static_cast<hsize_t>(endLine - startLine + 1)};
+    std::vector<EdgeOffset> lookup(count[0] * 2);
+    file.readRows("lookup", startLine, count[0], lookup.data());
+
+    std::vector<EdgeOffset> degrees(count[0]);
+    for (size_t i = 0; i < count[0]; ++i)
+    {
+        degrees[i] = lookup[i * 2 + 1] - lookup[i * 2] - 1;
+    }
+    return degrees;
+}
+
+/*equal amount of vertices per rank, the last rank takes the remainder*/
+template <typename VertexId>
+std::pair<VertexId, VertexId> vertexBalancedRange(VertexId total_vertices, int mpi_rank, int mpi_size)
+{
+    VertexId verticesPerProcess = total_vertices / mpi_size;
+    if (verticesPerProcess == 0)
+    {
+        throw std::runtime_error("Too many processes for amount of nodes");
+    }
+
+    VertexId my_start_vertex_id = verticesPerProcess * mpi_rank;
+    VertexId my_end_vertex_id = (mpi_rank == mpi_size - 1) ? total_vertices - 1 : verticesPerProcess * (mpi_rank + 1) - 1;
+    return std::make_pair(my_start_vertex_id, my_end_vertex_id);
+}
+
+/*
+contiguous ranges with roughly equal weight per rank. every rank reads an equal slice of the lookup dataset, computes
+the weight of its vertices (1 + degree) and the prefix sums over them, and reports the split points that fall into its slice.
+with border_weight > 0 the slice is also read from the data dataset to estimate how many edges of a vertex will cross
+a rank boundary: an edge of length d crosses one with probability min(1, d / (total_vertices / mpi_size)).
+*/
+template <typename VertexId, typename EdgeOffset>
+std::pair<VertexId, VertexId> edgeBalancedRange(HDF5Reader &file, VertexId total_vertices, int mpi_rank, int mpi_size, double border_weight)
+{
+    std::pair<VertexId, VertexId> slice = vertexBalancedRange(total_vertices, mpi_rank, mpi_size);
+
+    std::vector<long long> weights;
+    if (border_weight > 0)
+    {
+        Graph<VertexId, EdgeOffset> g_slice = readSubgraphFromHDF5<VertexId, EdgeOffset>(file, slice.first, slice.second);
+        double expected_range = static_cast<double>(total_vertices) / mpi_size;
+        weights.resize(g_slice.vertexCount);
+        for (VertexId v = slice.first; v <= slice.second; ++v)
+        {
+            double expected_border = 0;
+            for (VertexId w : g_slice[v])
+            {
+                expected_border += std::min(1.0, std::abs(static_cast<double>(w - v)) / expected_range);
+            }
+            weights[v - slice.first] = 1 + g_slice[v].size() + std::llround(border_weight * expected_border);
+        }
+    }
+    else
+    {
+        std::vector<EdgeOffset> degrees = readDegreesFromHDF5<VertexId, EdgeOffset>(file, slice.first, slice.second);
+        weights.resize(degrees.size());
+        for (size_t i = 0; i < degrees.size(); ++i)
+        {
+            weights[i] = 1 + degrees[i];
+        }
+    }
+
+    long long local_weight = 0;
+    for (long long w : weights)
+    {
+        local_weight += w;
+    }
+    long long prefix = 0;
+    long long total_weight = 0;
+    MPI_Exscan(&local_weight, &prefix, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&local_weight, &total_weight, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (mpi_rank == 0)
+    {
+        prefix = 0; // MPI_Exscan leaves the receive buffer of rank 0 undefined
+    }
+
+    // rank r starts at the first vertex whose exclusive prefix reaches r * total_weight / mpi_size
+    std::vector<VertexId> starts(mpi_size, total_vertices);
+    starts[0] = 0;
+    int r = 1;
+    while (r < mpi_size && (total_weight * r) / mpi_size < prefix)
+    {
+        r++;
+    }
+    for (size_t i = 0; i < weights.size() && r < mpi_size; ++i)
+    {
+        while (r < mpi_size && (total_weight * r) / mpi_size <= prefix)
+        {
+            starts[r++] = slice.first + i;
+        }
+        prefix += weights[i];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, starts.data(), mpi_size, MPIType<VertexId>::get(), MPI_MIN, MPI_COMM_WORLD);
+
+    // every rank needs at least one vertex
+    for (int i = 1; i < mpi_size; ++i)
+    {
+        starts[i] = std::min<VertexId>(std::max<VertexId>(starts[i], starts[i - 1] + 1), total_vertices - (mpi_size - i));
+    }
+
+    VertexId my_end_vertex_id = (mpi_rank == mpi_size - 1) ? total_vertices - 1 : starts[mpi_rank + 1] - 1;
+    return std::make_pair(starts[mpi_rank], my_end_vertex_id);
+}
+
+/*edgeBalancedRange() for a mapped CSR file: the offsets already are the prefix sums of the degrees, so every rank finds all split points with a binary search*/
+template <typename VertexId, typename EdgeOffset>
+std::pair<VertexId, VertexId> mappedEdgeBalancedRange(const MappedGraph &mapping, int mpi_rank, int mpi_size)
+{
+    const EdgeOffset *offsets = mapping.offsets<VertexId, EdgeOffset>();
+    VertexId total_vertices = mapping.vertices();
+    if (total_vertices < mpi_size)
+    {
+        throw std::runtime_error("Too many processes for amount of nodes");
+    }
+    long long total_weight = total_vertices + static_cast<long long>(offsets[total_vertices] - offsets[0]);
+
+    // rank r starts at the first vertex v whose exclusive prefix v + offsets[v] reaches r * total_weight / mpi_size
+    std::vector<VertexId> starts(mpi_size + 1, total_vertices);
+    starts[0] = 0;
+    for (int r = 1; r < mpi_size; ++r)
+    {
+        long long target = (total_weight * r) / mpi_size;
+        VertexId low = 0;
+        VertexId high = total_vertices;
+        while (low < high)
+        {
+            VertexId middle = low + (high - low) / 2;
+            if (middle + static_cast<long long>(offsets[middle] - offsets[0]) < target)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        // every rank needs at least one vertex
+        starts[r] = std::min<VertexId>(std::max<VertexId>(low, starts[r - 1] + 1), total_vertices - (mpi_size - r));
+    }
+    return std::make_pair(starts[mpi_rank], starts[mpi_rank + 1] - 1);
+}
+
+/*rank 0 prints the vertex range and edge count of every rank together with the imbalance (max / average)*/
+template <typename VertexId, typename EdgeOffset>
+void printPartition(const Graph<VertexId, EdgeOffset> &g_sub, int mpi_rank, int mpi_size)
+{
+    long long mine[3] = {g_sub.startVertexIndex, g_sub.startVertexIndex + g_sub.vertexCount - 1, static_cast<long long>(g_sub.edgeCount())};
+    std::vector<long long> all(3 * mpi_size);
+    MPI_Gather(mine, 3, MPI_LONG_LONG, all.data(), 3, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+
+    if (mpi_rank == 0)
+    {
+        long long max_edges = 0;
+        long long total_edges = 0;
+        for (int i = 0; i < mpi_size; ++i)
+        {
+            std::cout << "rank " << i << ": vertices " << all[i * 3] << " - " << all[i * 3 + 1]
+                      << " (" << all[i * 3 + 1] - all[i * 3] + 1 << " vertices, " << all[i * 3 + 2] << " edges)" << std::endl;
+            max_edges = std::max(max_edges, all[i * 3 + 2]);
+            total_edges += all[i * 3 + 2];
+        }
+        std::cout << "edge imbalance (max / average): " << (total_edges > 0 ? static_cast<double>(max_edges) * mpi_size / total_edges : 1.0) << std::endl;
+    }
+}
+
+/*rank 0 prints the amount of data every rank read from the HDF5 file and the achieved bandwidth*/
+void printReadBandwidth(const HDF5Reader &file, int mpi_rank, int mpi_size)
+{
+    double mine[2] = {static_cast<double>(file.bytes_read), file.read_seconds};
+    std::vector<double> all(2 * mpi_size);
+    MPI_Gather(mine, 2, MPI_DOUBLE, all.data(), 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    if (mpi_rank == 0)
+    {
+        double total_bytes = 0;
+        double max_seconds = 0;
+        for (int i = 0; i < mpi_size; ++i)
+        {
+            double megabytes = all[i * 2] / (1024 * 1024);
+            std::cout << "rank " << i << ": read " << megabytes << " MiB in " << all[i * 2 + 1] << " s ("
+                      << (all[i * 2 + 1] > 0 ? megabytes / all[i * 2 + 1] : 0) << " MiB/s)" << std::endl;
+            total_bytes += all[i * 2];
+            max_seconds = std::max(max_seconds, all[i * 2 + 1]);
+        }
+        std::cout << "aggregate read bandwidth: " << (max_seconds > 0 ? total_bytes / (1024 * 1024) / max_seconds : 0) << " MiB/s" << std::endl;
+    }
+}
+
+/*returns the first vertex id of every rank*/
+template <typename VertexId>
+std::vector<VertexId> gatherRangeStarts(VertexId my_start, int mpi_size)
+{
+    std::vector<VertexId> range_starts(mpi_size);
+    MPI_Allgather(&my_start, 1, MPIType<VertexId>::get(), range_starts.data(), 1, MPIType<VertexId>::get(), MPI_COMM_WORLD);
+    return range_starts;
+}
+
+/*rank whose range contains id*/
+template <typename VertexId>
+int ownerOf(const std::vector<VertexId> &range_starts, VertexId id)
+{
+    return std::upper_bound(range_starts.begin(), range_starts.end(), id) - range_starts.begin() - 1;
+}
+
+/*personalized all-to-all: sends outgoing[r] to rank r (emptying outgoing) and returns everything received, in rank order*/
+template <typename VertexId>
+std::vector<VertexId> exchangeBuckets(std::vector<std::vector<VertexId>> &outgoing)
+{
+    int mpi_size = outgoing.size();
+    std::vector<int> send_counts(mpi_size);
+    std::vector<int> send_displacements(mpi_size);
+    int send_total = 0;
+    for (int i = 0; i < mpi_size; ++i)
+    {
+        send_counts[i] = outgoing[i].size();
+        send_displacements[i] = send_total;
+        send_total += send_counts[i];
+    }
+    std::vector<VertexId> send_buffer;
+    send_buffer.reserve(send_total);
+    for (int i = 0; i < mpi_size; ++i)
+    {
+        send_buffer.insert(send_buffer.end(), outgoing[i].begin(), outgoing[i].end());
+        std::vector<VertexId>().swap(outgoing[i]);
+    }
+
+    std::vector<int> receive_counts(mpi_size);
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, receive_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    std::vector<int> receive_displacements(mpi_size);
+    int receive_total = 0;
+    for (int i = 0; i < mpi_size; ++i)
+    {
+        receive_displacements[i] = receive_total;
+        receive_total += receive_counts[i];
+    }
+
+    std::vector<VertexId> receive_buffer(receive_total);
+    MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displacements.data(), MPIType<VertexId>::get(),
+                  receive_buffer.data(), receive_counts.data(), receive_displacements.data(), MPIType<VertexId>::get(), MPI_COMM_WORLD);
+    return receive_buffer;
+}
+
+/*splitmix64 finalizer: a well mixed 64 bit value for every input, used as a counter based random number generator*/
+inline uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/*j-th random number of generated edge e, the same on every rank and for every amount of ranks*/
+inline uint64_t edgeRandom(uint64_t seed, uint64_t e, uint64_t j)
+{
+    return splitmix64(splitmix64(seed * 0x9E3779B97F4A7C15ull + e) + j);
+}
+
+/*
+bijection of [0, 2^scale) that scatters neighboring ids over the whole range: a xor-shift by at least half the bits
+(which is its own inverse) followed by a multiplication with an odd constant modulo 2^scale
+*/
+class IdScrambler
+{
+private:
+    uint64_t mask;
+    int shift;
+    uint64_t multiplier;
+    uint64_t inverse_multiplier;
+
+public:
+    IdScrambler(int scale, uint64_t seed)
+    {
+        mask = (uint64_t(1) << scale) - 1;
+        shift = (scale + 1) / 2;
+        multiplier = splitmix64(seed) | 1;
+        // newton iteration for the inverse modulo 2^64, every step doubles the amount of correct bits (3 after the start)
+        inverse_multiplier = multiplier;
+        for (int i = 0; i < 5; ++i)
+        {
+            inverse_multiplier *= 2 - multiplier * inverse_multiplier;
+        }
+    }
+
+    uint64_t operator()(uint64_t x) const
+    {
+        x ^= x >> shift;
+        return (x * multiplier) & mask;
+    }
+
+    uint64_t inverse(uint64_t y) const
+    {
+        y = (y * inverse_multiplier) & mask;
+        return y ^ (y >> shift);
+    }
+};
+
+/*
+generates the part [my_start, my_end] of a synthetic undirected graph with 2^config.scale vertices. the graph only
+depends on the configuration, not on the amount of ranks:
+- grid, path and ladder: every rank lists the neighbors of its own vertices
+- Erdos-Renyi and R-MAT: the random numbers of edge e only depend on the seed and e. every rank draws an equal share
+  of the edge_factor * 2^scale edges and sends both directions to the ranks owning the endpoints. self loops are
+  dropped and duplicate edges are merged, so the graph has somewhat fewer edges than drawn.
+with scrambled ids (always for R-MAT, like Graph500), id x of the plain graph becomes IdScrambler(x).
+*/
+template <typename VertexId, typename EdgeOffset>
+Graph<VertexId, EdgeOffset> generateSubgraph(const Config &config, VertexId my_start, VertexId my_end, int mpi_rank, int mpi_size)
+{
+    uint64_t total_vertices = uint64_t(1) << config.scale;
+    IdScrambler scramble(config.scale, config.seed);
+    bool scrambled = config.scramble || config.generator == GENERATE_RMAT;
+    std::vector<std::pair<VertexId, VertexId>> edges;
+
+    if (config.generator == GENERATE_ER || config.generator == GENERATE_RMAT)
+    {
+        // Graph500 R-MAT probabilities of the four quadrants, d = 1 - a - b - c
+        const double a = 0.57, b = 0.19, c = 0.19;
+        uint64_t total_edges = uint64_t(config.edge_factor) * total_vertices;
+        uint64_t first_edge = total_edges / mpi_size * mpi_rank + std::min<uint64_t>(mpi_rank, total_edges % mpi_size);
+        uint64_t last_edge = first_edge + total_edges / mpi_size + (uint64_t(mpi_rank) < total_edges % mpi_size ? 1 : 0);
+
+        std::vector<VertexId> range_starts = gatherRangeStarts(my_start, mpi_size);
+        // [vertex, neighbor, vertex, neighbor, ...] per rank owning the vertex
+        std::vector<std::vector<VertexId>> outgoing(mpi_size);
+        for (uint64_t e = first_edge; e < last_edge; ++e)
+        {
+            uint64_t u = 0;
+            uint64_t v = 0;
+            if (config.generator == GENERATE_ER)
+            {
+                u = edgeRandom(config.seed, e, 0) & (total_vertices - 1);
+                v = edgeRandom(config.seed, e, 1) & (total_vertices - 1);
+            }
+            else
+            {
+                for (int level = 0; level < config.scale; ++level)
+                {
+                    double r = (edgeRandom(config.seed, e, level) >> 11) / 9007199254740992.0; // 53 random bits in [0, 1)
+                    u = u * 2 + (r >= a + b ? 1 : 0);
+                    v = v * 2 + ((r >= a && r < a + b) || r >= a + b + c ? 1 : 0);
+                }
+            }
+            if (u == v)
+            {
+                continue;
+            }
+            if (scrambled)
+            {
+                u = scramble(u);
+                v = scramble(v);
+            }
+            std::vector<VertexId> &to_u = outgoing[ownerOf(range_starts, static_cast<VertexId>(u))];
+            to_u.push_back(u);
+            to_u.push_back(v);
+            std::vector<VertexId> &to_v = outgoing[ownerOf(range_starts, static_cast<VertexId>(v))];
+            to_v.push_back(v);
+            to_v.push_back(u);
+        }
+
+        std::vector<VertexId> received = exchangeBuckets(outgoing);
+        edges.reserve(received.size() / 2);
+        for (size_t i = 0; i < received.size(); i += 2)
+        {
+            edges.emplace_back(received[i], received[i + 1]);
+        }
+    }
+    else
+    {
+        uint64_t rows = uint64_t(1) << (config.scale / 2);
+        uint64_t columns = total_vertices / rows;
+        uint64_t neighbors[4];
+        for (uint64_t id = my_start; id <= uint64_t(my_end); ++id)
+        {
+            uint64_t x = scrambled ? scramble.inverse(id) : id;
+            int count = 0;
+            if (config.generator == GENERATE_GRID)
+            {
+                if (x >= columns)
+                {
+                    neighbors[count++] = x - columns;
+                }
+                if (x + columns < total_vertices)
+                {
+                    neighbors[count++] = x + columns;
+                }
+                if (x % columns != 0)
+                {
+                    neighbors[count++] = x - 1;
+                }
+                if (x % columns != columns - 1)
+                {
+                    neighbors[count++] = x + 1;
+                }
+            }
+            else if (config.generator == GENERATE_PATH)
+            {
+                if (x > 0)
+                {
+                    neighbors[count++] = x - 1;
+                }
+                if (x + 1 < total_vertices)
+                {
+                    neighbors[count++] = x + 1;
+                }
+            }
+            else
+            {
+                // the two rails are the even and the odd ids, x and x ^ 1 form a rung
+                neighbors[count++] = x ^ 1;
+                if (x >= 2)
+                {
+                    neighbors[count++] = x - 2;
+                }
+                if (x + 2 < total_vertices)
+                {
+                    neighbors[count++] = x + 2;
+                }
+            }
+            for (int i = 0; i < count; ++i)
+            {
+                edges.emplace_back(id, scrambled ? scramble(neighbors[i]) : neighbors[i]);
+            }
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    if (edges.size() > static_cast<uint64_t>(std::numeric_limits<EdgeOffset>::max()))
+    {
+        throw std::runtime_error("Too many edges on one rank for EdgeOffset, build with EDGE_OFFSET_BITS=64");
+    }
+    return Graph<VertexId, EdgeOffset>::fromEdges(my_end - my_start + 1, my_start, edges, true);
+}
+
+/*
+sends the label of every border vertex to the ranks that own one of its foreign neighbors. the graph is undirected, so
+every rank receives exactly the labels of the foreign vertices it is adjacent to, instead of the labels of all border
+vertices of the graph.
+*/
+template <typename VertexId, typename EdgeOffset>
+std::unordered_map<VertexId, VertexId> exchangeBorderLabels(const Graph<VertexId, EdgeOffset> &g_sub, const std::vector<VertexId> &labels, int mpi_size)
+{
+    std::vector<VertexId> range_starts = gatherRangeStarts(g_sub.startVertexIndex, mpi_size);
+
+    // [vertex, label, vertex, label, ...] per destination rank, every vertex once per destination
+    std::vector<std::vector<VertexId>> outgoing(mpi_size);
+    std::vector<int> destinations;
+    for (const auto &node : g_sub.local_to_foreign_nodes)
+    {
+        destinations.clear();
+        for (VertexId foreign : node.second)
+        {
+            destinations.push_back(ownerOf(range_starts, foreign));
+        }
+        std::sort(destinations.begin(), destinations.end());
+        destinations.erase(std::unique(destinations.begin(), destinations.end()), destinations.end());
+        for (int destination : destinations)
+        {
+            outgoing[destination].push_back(node.first);
+            outgoing[destination].push_back(labels[node.first - g_sub.startVertexIndex]);
+        }
+    }
+
+    std::vector<VertexId> received = exchangeBuckets(outgoing);
+
+    std::unordered_map<VertexId, VertexId> foreign_ID_to_label;
+    foreign_ID_to_label.reserve(received.size() / 2);
+    for (size_t i = 0; i < received.size(); i += 2)
+    {
+        foreign_ID_to_label[received[i]] = received[i + 1];
+    }
+    return foreign_ID_to_label;
+}
+
+/*
+counts the vertices of every component. the label of a component is a vertex id, so the rank whose range contains it
+adds up the counts of all ranks. returns [label, size, label, size, ...] of the labels in this rank's range, sorted by label.
+*/
+template <typename VertexId>
+std::vector<VertexId> componentSizes(const std::vector<VertexId> &labels, VertexId my_start, int mpi_size)
+{
+    std::unordered_map<VertexId, VertexId> local_sizes;
+    for (VertexId label : labels)
+    {
+        local_sizes[label]++;
+    }
+
+    std::vector<VertexId> range_starts = gatherRangeStarts(my_start, mpi_size);
+    std::vector<std::vector<VertexId>> outgoing(mpi_size);
+    for (const auto &entry : local_sizes)
+    {
+        int owner = ownerOf(range_starts, entry.first);
+        outgoing[owner].push_back(entry.first);
+        outgoing[owner].push_back(entry.second);
+    }
+
+    std::vector<VertexId> received = exchangeBuckets(outgoing);
+
+    std::vector<std::pair<VertexId, VertexId>> sizes;
+    sizes.reserve(received.size() / 2);
+    for (size_t i = 0; i < received.size(); i += 2)
+    {
+        sizes.emplace_back(received[i], received[i + 1]);
+    }
+    std::sort(sizes.begin(), sizes.end());
+
+    std::vector<VertexId> table;
+    table.reserve(received.size());
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        if (!table.empty() && table[table.size() - 2] == sizes[i].first)
+        {
+            table.back() += sizes[i].second;
+        }
+        else
+        {
+            table.push_back(sizes[i].first);
+            table.push_back(sizes[i].second);
+        }
+    }
+    return table;
+}
+
+/*
+writes the label of every vertex to the dataset "labels" of config.output_path (row i is the label of vertex i) and,
+with config.component_sizes, the rows (label, vertex count) of all components sorted by label to "component_sizes".
+table is this rank's part of them, as returned by componentSizes().
+*/
+template <typename VertexId>
+void writeLabels(const std::vector<VertexId> &labels, const std::vector<VertexId> &table, VertexId my_start, VertexId total_vertices, const Config &config, int mpi_rank)
+{
+    HDF5Writer file(config.output_path, MPI_COMM_WORLD);
+    file.writeRows("labels", total_vertices, 1, my_start, labels.size(), labels.data());
+
+    if (config.component_sizes)
+    {
+        long long my_rows = table.size() / 2;
+        long long first_row = 0;
+        long long total_rows = 0;
+        MPI_Exscan(&my_rows, &first_row, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(&my_rows, &total_rows, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        if (mpi_rank == 0)
+        {
+            first_row = 0; // MPI_Exscan leaves it undefined on rank 0
+        }
+        file.writeRows("component_sizes", total_rows, 2, first_row, my_rows, table.data());
+    }
+
+    double max_write_seconds;
+    long long total_bytes;
+    MPI_Reduce(&file.write_seconds, &max_write_seconds, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&file.bytes_written, &total_bytes, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (mpi_rank == 0)
+    {
+        std::cout << "wrote " << total_bytes << " bytes to " << config.output_path << " in " << max_write_seconds << " s" << std::endl;
+    }
+}
+
+/*
+reads this rank's share of a text file with one edge "u v" per line: the file is split into equal byte ranges and a
+line belongs to the rank whose range holds its first byte, so every rank only reads about 1 / mpi_size of the file.
+*/
+template <typename VertexId>
+std::vector<std::pair<VertexId, VertexId>> readEdgeBatch(const std::string &path, VertexId total_vertices, int mpi_rank, int mpi_size)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        throw std::runtime_error("Could not open edge batch " + path);
+    }
+    long long file_size = in.tellg();
+    long long begin = file_size / mpi_size * mpi_rank;
+    long long end = mpi_rank == mpi_size - 1 ? file_size : file_size / mpi_size * (mpi_rank + 1);
+
+    // a line that starts before begin belongs to the previous rank
+    in.seekg(std::max(begin - 1, 0LL));
+    std::string line;
+    if (begin > 0)
+    {
+        std::getline(in, line);
+    }
+
+    std::vector<std::pair<VertexId, VertexId>> edges;
+    while (in && static_cast<long long>(in.tellg()) < end && std::getline(in, line))
+    {
+        long long u;
+        long long v;
+        if (sscanf(line.c_str(), "%lld %lld", &u, &v) != 2)
+        {
+            continue; // empty lines and comments
+        }
+        if (u < 0 || v < 0 || u >= total_vertices || v >= total_vertices)
+        {
+            throw std::runtime_error("Edge " + std::to_string(u) + " " + std::to_string(v) + " of " + path + " is out of range");
+        }
+        edges.emplace_back(u, v);
+    }
+    return edges;
+}
+
+/*
+adds a batch of edges to the components of a finished run. labels (this rank's vertices, as after the reduction)
+stay untouched; label_sets is a union-find over the labels that every rank holds a copy of, and find() on it gives the
+current label of a component. the batch is only routed and reduced, so the cost grows with the batch, not the graph:
+1. every edge (u, v) goes to the owner of u, which replaces u by its label, then to the owner of v, which does the same
+2. the pairs of labels that are still in different sets are the edges of a CAG over the touched components only. it is
+   small, so it is gathered on every rank instead of going through the reduction tree.
+3. every rank unites the pairs in the same order (the smaller label survives, as in the CAG), which keeps the copies equal
+returns the amount of components that were merged into others.
+*/
+template <typename VertexId>
+size_t applyEdgeBatch(const std::string &path, const std::vector<VertexId> &labels, DisjointSets<VertexId> &label_sets, VertexId my_start, VertexId total_vertices, int mpi_rank, int mpi_size)
+{
+    std::vector<std::pair<VertexId, VertexId>> edges = readEdgeBatch(path, total_vertices, mpi_rank, mpi_size);
+    std::vector<VertexId> range_starts = gatherRangeStarts(my_start, mpi_size);
+
+    std::vector<std::vector<VertexId>> outgoing(mpi_size);
+    for (const auto &edge : edges)
+    {
+        std::vector<VertexId> &to_owner = outgoing[ownerOf(range_starts, edge.first)];
+        to_owner.push_back(edge.first);
+        to_owner.push_back(edge.second);
+    }
+    std::vector<std::pair<VertexId, VertexId>>().swap(edges);
+
+    // [label of u, v] at the owner of u, then [label of u, label of v] at the owner of v
+    std::vector<VertexId> received = exchangeBuckets(outgoing);
+    for (size_t i = 0; i < received.size(); i += 2)
+    {
+        std::vector<VertexId> &to_owner = outgoing[ownerOf(range_starts, received[i + 1])];
+        to_owner.push_back(label_sets.find(labels[received[i] - my_start]));
+        to_owner.push_back(received[i + 1]);
+    }
+    received = exchangeBuckets(outgoing);
+
+    std::vector<std::pair<VertexId, VertexId>> pairs;
+    for (size_t i = 0; i < received.size(); i += 2)
+    {
+        VertexId a = received[i];
+        VertexId b = label_sets.find(labels[received[i + 1] - my_start]);
+        if (a != b)
+        {
+            pairs.emplace_back(std::min(a, b), std::max(a, b));
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    std::vector<VertexId> mine;
+    mine.reserve(pairs.size() * 2);
+    for (const auto &pair : pairs)
+    {
+        mine.push_back(pair.first);
+        mine.push_back(pair.second);
+    }
+    int my_count = mine.size();
+    std::vector<int> counts(mpi_size);
+    MPI_Allgather(&my_count, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    std::vector<int> displacements(mpi_size, 0);
+    for (int i = 1; i < mpi_size; ++i)
+    {
+        displacements[i] = displacements[i - 1] + counts[i - 1];
+    }
+    std::vector<VertexId> all(displacements.back() + counts.back());
+    MPI_Allgatherv(mine.data(), my_count, MPIType<VertexId>::get(), all.data(), counts.data(), displacements.data(), MPIType<VertexId>::get(), MPI_COMM_WORLD);
+
+    size_t merges = 0;
+    for (size_t i = 0; i < all.size(); i += 2)
+    {
+        VertexId a = label_sets.find(all[i]);
+        VertexId b = label_sets.find(all[i + 1]);
+        if (a != b)
+        {
+            label_sets.unite(a, b, std::min(a, b));
+            merges++;
+        }
+    }
+    return merges;
+}
+
+/*
+rank 0 prints the amount of components, the largest one, the amount of singletons and a histogram of the component
+sizes in powers of two. every rank only looks at its part of the size table, so only the reduced numbers reach rank 0.
+*/
+template <typename VertexId>
+void printComponentStats(const std::vector<VertexId> &table, int mpi_rank)
+{
+    const int buckets = 64;
+    // components, singletons, then the histogram: bucket b counts the components with 2^b <= size < 2^(b+1)
+    std::vector<long long> counts(2 + buckets, 0);
+    long long largest_size = 0;
+    for (size_t i = 0; i < table.size(); i += 2)
+    {
+        long long size = table[i + 1];
+        counts[0]++;
+        if (size == 1)
+        {
+            counts[1]++;
+        }
+        int bucket = 0;
+        while ((size >> (bucket + 1)) > 0)
+        {
+            bucket++;
+        }
+        counts[2 + bucket]++;
+        largest_size = std::max(largest_size, size);
+    }
+
+    std::vector<long long> total_counts(counts.size());
+    MPI_Reduce(counts.data(), total_counts.data(), counts.size(), MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    // the label of the largest component: the smallest label of all components that have the largest size
+    long long global_largest_size;
+    MPI_Allreduce(&largest_size, &global_largest_size, 1, MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+    long long largest_label = std::numeric_limits<long long>::max();
+    for (size_t i = 0; i < table.size(); i += 2)
+    {
+        if (table[i + 1] == global_largest_size)
+        {
+            largest_label = std::min<long long>(largest_label, table[i]);
+        }
+    }
+    long long global_largest_label;
+    MPI_Reduce(&largest_label, &global_largest_label, 1, MPI_LONG_LONG, MPI_MIN, 0, MPI_COMM_WORLD);
+
+    if (mpi_rank == 0)
+    {
+        std::cout << std::endl
+                  << "Number of connected components: " << total_counts[0] << std::endl;
+        if (total_counts[0] > 0)
+        {
+            std::cout << "largest component: label " << global_largest_label << ", " << global_largest_size << " vertices" << std::endl;
+        }
+        std::cout << "singletons: " << total_counts[1] << std::endl
+                  << "component sizes:";
+        for (int b = 0; b < buckets; ++b)
+        {
+            if (total_counts[2 + b] > 0)
+            {
+                std::cout << " [" << (1ll << b) << ", " << (1ll << (b + 1)) - 1 << "]: " << total_counts[2 + b];
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+/*rank 0 prints the size of its CAG after a level of the reduction tree and the slowest exchange + merge time of all ranks*/
+template <typename VertexId>
+void printCAGLevel(CAG<VertexId> &cag, int level, double level_seconds, const WireBytes &wire_bytes, unsigned long long allocations, int mpi_rank)
+{
+    double max_level_seconds;
+    MPI_Reduce(&level_seconds, &max_level_seconds, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    unsigned long long counts[3] = {wire_bytes.raw, wire_bytes.encoded, allocations};
+    unsigned long long totals[3];
+    MPI_Reduce(counts, totals, 3, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (mpi_rank == 0)
+    {
+        size_t edges = cag.edgeCount();
+        std::cout << "level " << level << ": exchange + merge " << max_level_seconds << " s, cag nodes " << cag.nodes.size()
+                  << " (" << cag.nodes_before_contraction << " before contraction), edges " << edges
+                  << ", bytes per edge " << (edges > 0 ? static_cast<double>(cag.memoryBytes()) / edges : 0)
+                  << ", sent " << totals[1] << " of " << totals[0] << " raw bytes, scratch allocations " << totals[2] << std::endl;
+    }
+}
+
+/*peak resident set size of this process in KiB*/
+inline long maxRSSKiB()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*
+instrumentation of one run on one rank: wall times of phases and counters, in the order they are recorded. every rank
+records the same entries in the same order, so aggregate() combines them entry by entry.
+*/
+class Profile
+{
+public:
+    struct Entry
+    {
+        std::string name;
+        std::string unit;
+        double value;
+    };
+
+    /// @brief one entry over all ranks
+    struct Summary
+    {
+        std::string name;
+        std::string unit;
+        double min;
+        double median;
+        double max;
+    };
+
+private:
+    std::vector<Entry> entries;
+    double lap_start;
+
+public:
+    Profile() : lap_start(MPI_Wtime()) {}
+
+    void record(const std::string &name, const std::string &unit, double value)
+    {
+        Entry entry = {name, unit, value};
+        entries.push_back(entry);
+    }
+
+    /*records the wall time since the previous lap() or skip() as the phase name*/
+    void lap(const std::string &name)
+    {
+        double now = MPI_Wtime();
+        record(name, "s", now - lap_start);
+        lap_start = now;
+    }
+
+    /*starts the next phase without recording the time since the previous one, e.g. after printing*/
+    void skip()
+    {
+        lap_start = MPI_Wtime();
+    }
+
+    /*collective, the summaries are only returned on rank 0*/
+    std::vector<Summary> aggregate(int mpi_rank, int mpi_size) const
+    {
+        int count = entries.size();
+        int counts[2] = {-count, count};
+        MPI_Allreduce(MPI_IN_PLACE, counts, 2, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        if (-counts[0] != counts[1])
+        {
+            throw std::runtime_error("ranks recorded different amounts of profile entries");
+        }
+
+        std::vector<double> values(count);
+        for (int i = 0; i < count; ++i)
+        {
+            values[i] = entries[i].value;
+        }
+        std::vector<double> all(mpi_rank == 0 ? count * mpi_size : 0);
+        MPI_Gather(values.data(), count, MPI_DOUBLE, all.data(), count, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+        std::vector<Summary> summaries;
+        if (mpi_rank == 0)
+        {
+            std::vector<double> column(mpi_size);
+            for (int i = 0; i < count; ++i)
+            {
+                for (int r = 0; r < mpi_size; ++r)
+                {
+                    column[r] = all[r * count + i];
+                }
+                std::sort(column.begin(), column.end());
+                double median = (column[(mpi_size - 1) / 2] + column[mpi_size / 2]) / 2;
+                Summary summary = {entries[i].name, entries[i].unit, column.front(), median, column.back()};
+                summaries.push_back(summary);
+            }
+        }
+        return summaries;
+    }
+};
+
+/*seconds keep the default stream precision, counters are printed as integers. only the median of an even amount of ranks can fall between two counts*/
+void writeProfileValue(std::ostream &out, const std::string &unit, double value)
+{
+    if (unit == "s")
+    {
+        out << value;
+        return;
+    }
+    long long whole = (long long)std::floor(value);
+    out << whole;
+    if (value != whole)
+    {
+        out << ".5";
+    }
+}
+
+/*writes the summaries of every timed run as JSON ({"ranks": .., "runs": [[{entry}, ..], ..]}) or as CSV*/
+void writeProfiles(std::ostream &out, StatsFormat format, const std::vector<std::vector<Profile::Summary>> &runs, int mpi_size)
+{
+    if (format == STATS_CSV)
+    {
+        out << "run,name,unit,min,median,max" << std::endl;
+        for (size_t r = 0; r < runs.size(); ++r)
+        {
+            for (const Profile::Summary &s : runs[r])
+            {
+                out << r << "," << s.name << "," << s.unit << ",";
+                writeProfileValue(out, s.unit, s.min);
+                out << ",";
+                writeProfileValue(out, s.unit, s.median);
+                out << ",";
+                writeProfileValue(out, s.unit, s.max);
+                out << std::endl;
+            }
+        }
+        return;
+    }
+
+    out << "{\"ranks\": " << mpi_size << ", \"runs\": [";
+    for (size_t r = 0; r < runs.size(); ++r)
+    {
+        out << (r > 0 ? ",\n  [" : "\n  [");
+        for (size_t i = 0; i < runs[r].size(); ++i)
+        {
+            const Profile::Summary &s = runs[r][i];
+            out << (i > 0 ? ",\n    " : "\n    ") << "{\"name\": \"" << s.name << "\", \"unit\": \"" << s.unit << "\", \"min\": ";
+            writeProfileValue(out, s.unit, s.min);
+            out << ", \"median\": ";
+            writeProfileValue(out, s.unit, s.median);
+            out << ", \"max\": ";
+            writeProfileValue(out, s.unit, s.max);
+            out << "}";
+        }
+        out << "]";
+    }
+    out << "]}" << std::endl;
+}
+
+/*records the times and counters of one level of the reduction tree. contract_seconds is the part of level_seconds spent in completeMerge()*/
+template <typename VertexId>
+void recordCAGLevel(Profile &profile, CAG<VertexId> &cag, int level, double level_seconds, double contract_seconds, const WireBytes &wire_bytes, unsigned long long allocations)
+{
+    std::string prefix = "level " + std::to_string(level) + " ";
+    profile.record(prefix + "exchange + merge", "s", level_seconds - contract_seconds);
+    profile.record(prefix + "contract", "s", contract_seconds);
+    size_t edges = cag.edgeCount();
+    profile.record(prefix + "cag nodes", "nodes", cag.nodes.size());
+    profile.record(prefix + "nodes before contraction", "nodes", cag.nodes_before_contraction);
+    profile.record(prefix + "cag edges", "edges", edges);
+    profile.record(prefix + "bytes sent", "bytes", wire_bytes.encoded);
+    profile.record(prefix + "raw bytes", "bytes", wire_bytes.raw);
+    profile.record(prefix + "scratch allocations", "allocations", allocations);
+    profile.record(prefix + "union-find entries", "entries", cag.union_find.size());
+    profile.record(prefix + "max rss", "KiB", maxRSSKiB());
+}
+
+/*
+communicator of the ranks that share memory with this one, narrowed to groups of ranks_per_node consecutive ranks if
+ranks_per_node > 0, which emulates smaller nodes. the ranks of every node have to be consecutive, since the first rank
+of a node merges the CAGs of the others and merges only work on adjacent id ranges.
+*/
+MPI_Comm splitNodes(int ranks_per_node, int mpi_rank)
+{
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, mpi_rank, MPI_INFO_NULL, &node_comm);
+    if (ranks_per_node > 0)
+    {
+        MPI_Comm group_comm;
+        MPI_Comm_split(node_comm, mpi_rank / ranks_per_node, mpi_rank, &group_comm);
+        MPI_Comm_free(&node_comm);
+        node_comm = group_comm;
+    }
+
+    int node_rank, node_size;
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_size(node_comm, &node_size);
+    int bounds[2] = {-mpi_rank, mpi_rank};
+    int node_bounds[2];
+    MPI_Allreduce(bounds, node_bounds, 2, MPI_INT, MPI_MAX, node_comm);
+    int consecutive = (-node_bounds[0] == mpi_rank - node_rank && node_bounds[1] == mpi_rank - node_rank + node_size - 1) ? 1 : 0;
+    int all_consecutive;
+    MPI_Allreduce(&consecutive, &all_consecutive, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!all_consecutive)
+    {
+        throw std::runtime_error("--reduction=node needs consecutive ranks on every node, e.g. mpiexec --map-by core");
+    }
+    return node_comm;
+}
+
+/*
+the end of run() and runFromLabels(): adds the edge batches of config to the components given by labels (this rank's
+vertices, starting at my_start), then counts the component sizes and writes the output
+*/
+template <typename VertexId>
+int applyBatchesAndWrite(std::vector<VertexId> &labels, VertexId my_start, VertexId total_vertices, const Config &config, Profile &profile, int mpi_rank, int mpi_size)
+{
+    if (!config.batch_paths.empty())
+    {
+        DisjointSets<VertexId> label_sets;
+        for (size_t b = 0; b < config.batch_paths.size(); ++b)
+        {
+            profile.skip();
+            size_t merges = applyEdgeBatch(config.batch_paths[b], labels, label_sets, my_start, total_vertices, mpi_rank, mpi_size);
+            profile.lap("batch " + std::to_string(b));
+            profile.record("batch " + std::to_string(b) + " merges", "components", merges);
+            if (mpi_rank == 0)
+            {
+                std::cout << "batch " << config.batch_paths[b] << ": " << merges << " components merged" << std::endl;
+            }
+        }
+
+        profile.skip();
+        for (size_t i = 0; i < labels.size(); ++i)
+        {
+            labels[i] = label_sets.find(labels[i]);
+        }
+        profile.lap("batch relabel");
+    }
+
+    std::vector<VertexId> size_table; // [label, size, ...] of the components whose label lies in this rank's range
+    if (COUNT_CC || config.component_sizes)
+    {
+        size_table = componentSizes(labels, my_start, mpi_size);
+    }
+    profile.lap("component sizes");
+
+    if (!config.output_path.empty())
+    {
+        writeLabels(labels, size_table, my_start, total_vertices, config, mpi_rank);
+    }
+    profile.lap("output");
+
+    if (COUNT_CC)
+    {
+        printComponentStats(size_table, mpi_rank);
+    }
+    profile.record("max rss", "KiB", maxRSSKiB());
+    return 0;
+}
+
+template <typename VertexId, typename EdgeOffset>
+int run(int mpi_rank, int mpi_size, const Config &config, Profile &profile)
+{
+
+    int xx = 0;
+    while (DEBUG_CONDITION && xx == 0 /*  && mpi_rank == RANK_OF_INTEREST */)
+    {
+        sleep(5);
+    }
+
+    VertexId total_vertices;
+    Graph<VertexId, EdgeOffset> g_sub;
+    if (config.generator != GENERATE_NONE)
+    {
+        profile.skip();
+        if (config.scale < 1 || config.scale >= std::numeric_limits<VertexId>::digits)
+        {
+            throw std::runtime_error("Scale out of range for VertexId, build with VERTEX_ID_BITS=64 for larger graphs");
+        }
+        total_vertices = VertexId(1) << config.scale;
+        std::pair<VertexId, VertexId> my_range = vertexBalancedRange(total_vertices, mpi_rank, mpi_size);
+        g_sub = generateSubgraph<VertexId, EdgeOffset>(config, my_range.first, my_range.second, mpi_rank, mpi_size);
+        profile.lap("generate");
+
+        if (PRINT_PARTITION)
+        {
+            printPartition(g_sub, mpi_rank, mpi_size);
+        }
+    }
+    else if (MappedGraph::matches(config.input_path))
+    {
+        profile.skip();
+        std::shared_ptr<const MappedGraph> mapping = std::make_shared<const MappedGraph>(config.input_path);
+        if (mapping->vertices() > std::numeric_limits<VertexId>::max())
+        {
+            throw std::runtime_error("The graph has too many vertices for VertexId, build with VERTEX_ID_BITS=64");
+        }
+        total_vertices = mapping->vertices();
+        profile.lap("open");
+
+        std::pair<VertexId, VertexId> my_range;
+        if (config.partition_mode == PARTITION_EDGES)
+        {
+            if (config.border_weight > 0)
+            {
+                throw std::runtime_error("--border-weight is only supported for HDF5 input files");
+            }
+            my_range = mappedEdgeBalancedRange<VertexId, EdgeOffset>(*mapping, mpi_rank, mpi_size);
+        }
+        else
+        {
+            my_range = vertexBalancedRange(total_vertices, mpi_rank, mpi_size);
+        }
+        g_sub = Graph<VertexId, EdgeOffset>::fromMapping(mapping, my_range.second - my_range.first + 1, my_range.first);
+        profile.lap("partition");
+
+        if (PRINT_PARTITION)
+        {
+            printPartition(g_sub, mpi_rank, mpi_size);
+        }
+    }
+    else
+    {
+        profile.skip();
+        HDF5Reader file(config.input_path, MPI_COMM_WORLD);
+        profile.lap("open");
+
+        total_vertices = readVerticesFromHDF5File<VertexId, EdgeOffset>(file);
+
+        std::pair<VertexId, VertexId> my_range;
+        if (config.partition_mode == PARTITION_EDGES)
+        {
+            my_range = edgeBalancedRange<VertexId, EdgeOffset>(file, total_vertices, mpi_rank, mpi_size, config.border_weight);
+        }
+        else
+        {
+            my_range = vertexBalancedRange(total_vertices, mpi_rank, mpi_size);
+        }
+        VertexId my_start_vertex_id = my_range.first;
+        VertexId my_end_vertex_id = my_range.second;
+        profile.lap("partition");
+
+        double load_start_time = MPI_Wtime();
+        double read_seconds_before = file.read_seconds;
+        g_sub = readSubgraphFromHDF5<VertexId, EdgeOffset>(file, my_start_vertex_id, my_end_vertex_id);
+        double read_seconds = file.read_seconds - read_seconds_before;
+        profile.record("read", "s", read_seconds);
+        profile.record("parse", "s", MPI_Wtime() - load_start_time - read_seconds);
+
+        if (PRINT_PARTITION)
+        {
+            printPartition(g_sub, mpi_rank, mpi_size);
+        }
+
+        if (PRINT_READ_BANDWIDTH)
+        {
+            printReadBandwidth(file, mpi_rank, mpi_size);
+        }
+    }
+
+    profile.skip();
+    std::vector<VertexId> labels = g_sub.connectedComponents(config.threads);
+    profile.lap("local cc");
+
+    std::unordered_map<VertexId, VertexId> foreign_ID_to_label = exchangeBorderLabels(g_sub, labels, mpi_size);
+    profile.lap("border exchange");
+
+    CAG<VertexId> cag = g_sub.createCAG(labels, foreign_ID_to_label);
+
+    cag.local_information_id_min = g_sub.startVertexIndex;
+    cag.local_information_id_max = g_sub.startVertexIndex + g_sub.vertexCount - 1;
+
+    cag.union_find.reset(g_sub.startVertexIndex, g_sub.vertexCount);
+    profile.lap("cag build");
+
+    // a rank that handed its CAG to parent_rank gets the labels of its local nodes back from there after the reduction,
+    // and answers the ranks that handed their CAGs to it (children) in the same way
+    int parent_rank = -1;
+    std::vector<std::pair<int, std::vector<VertexId>>> children; // rank and the ids mergeFromChild() returned
+    WireBytes fold_bytes; // the fold-in send is not part of a level
+
+    if (config.reduction_mode == REDUCTION_TREE || config.reduction_mode == REDUCTION_NODE)
+    {
+        std::vector<int> members; // the ranks in the binomial tree, in rank order
+        if (config.reduction_mode == REDUCTION_NODE)
+        {
+            /*
+            the other ranks of a node export their CAGs into a shared memory window, and the first rank of the node merges
+            them in place, without serializing them. the other ranks get their labels back like the children of the tree
+            */
+            MPI_Comm node_comm = splitNodes(config.ranks_per_node, mpi_rank);
+            int node_rank, node_size;
+            MPI_Comm_rank(node_comm, &node_rank);
+            MPI_Comm_size(node_comm, &node_size);
+
+            size_t exported_bytes = node_rank == 0 ? 0 : cag.exportedBytes();
+            char *segment;
+            MPI_Win window;
+            MPI_Win_allocate_shared(exported_bytes, 1, MPI_INFO_NULL, node_comm, &segment, &window);
+            if (node_rank != 0)
+            {
+                cag.exportTo(segment);
+                parent_rank = mpi_rank - node_rank;
+            }
+            MPI_Win_fence(0, window);
+            if (node_rank == 0)
+            {
+                std::vector<const char *> peer_cags(node_size - 1);
+                for (int r = 1; r < node_size; ++r)
+                {
+                    MPI_Aint size;
+                    int displacement_unit;
+                    char *base;
+                    MPI_Win_shared_query(window, r, &size, &displacement_unit, &base);
+                    peer_cags[r - 1] = base;
+                }
+                std::vector<std::vector<VertexId>> peer_local_ids = cag.mergeFromPeers(peer_cags);
+                for (int r = 1; r < node_size; ++r)
+                {
+                    children.emplace_back(mpi_rank + r, peer_local_ids[r - 1]);
+                }
+            }
+            MPI_Win_fence(0, window);
+            MPI_Win_free(&window);
+            MPI_Comm_free(&node_comm);
+
+            int leader = node_rank == 0 ? mpi_rank : -1;
+            std::vector<int> leaders(mpi_size);
+            MPI_Allgather(&leader, 1, MPI_INT, leaders.data(), 1, MPI_INT, MPI_COMM_WORLD);
+            for (int rank : leaders)
+            {
+                if (rank != -1)
+                {
+                    members.push_back(rank);
+                }
+            }
+            profile.record("node merge shared bytes", "bytes", exported_bytes);
+            profile.lap("node merge");
+        }
+        else
+        {
+            for (int rank = 0; rank < mpi_size; ++rank)
+            {
+                members.push_back(rank);
+            }
+        }
+        int position = std::find(members.begin(), members.end(), mpi_rank) - members.begin();
+
+        /*
+        binomial tree: on level i, every member at position % 2^(i+1) == 2^i hands its CAG to the member 2^i positions
+        before it and drops out. every pair covers two adjacent id ranges, only one side merges, and every rank only keeps
+        the union-find of the ranges that were merged into it.
+        */
+        for (int i = 0; (1 << i) < static_cast<int>(members.size()); ++i)
+        {
+            int distance = 1 << i;
+            double level_start_time = MPI_Wtime();
+            double contract_seconds_before = cag.contract_seconds;
+            unsigned long long allocations_before = scratchAllocations();
+            WireBytes wire_bytes;
+            if (parent_rank == -1)
+            {
+                if (position % (2 * distance) == distance)
+                {
+                    parent_rank = members[position - distance];
+                    cag.send(parent_rank, config.wire_format, wire_bytes);
+                }
+                else if (position + distance < static_cast<int>(members.size()))
+                {
+                    int child_rank = members[position + distance];
+                    children.emplace_back(child_rank, cag.mergeFromChild(child_rank, config.wire_format));
+                }
+            }
+            unsigned long long allocations = scratchAllocations() - allocations_before;
+            recordCAGLevel(profile, cag, i, MPI_Wtime() - level_start_time, cag.contract_seconds - contract_seconds_before, wire_bytes, allocations);
+
+            if (PRINT_CAG_LEVELS)
+            {
+                printCAGLevel(cag, i, MPI_Wtime() - level_start_time, wire_bytes, allocations, mpi_rank);
+            }
+        }
+    }
+    else
+    {
+        /*
+        butterfly: recursive doubling over the largest power of two tree_size <= mpi_size, both partners merge. the first
+        2 * excess ranks are paired up, the odd rank of each pair is a child of the even one and does not take part in the
+        tree. tree ranks keep the rank order, so partners always hold adjacent id ranges.
+        */
+        int tree_size = 1;
+        while (tree_size * 2 <= mpi_size)
+        {
+            tree_size *= 2;
+        }
+        int excess = mpi_size - tree_size;
+        int tree_rank; // -1 if this rank is folded into mpi_rank - 1
+        if (mpi_rank < 2 * excess)
+        {
+            tree_rank = (mpi_rank % 2 == 0) ? mpi_rank / 2 : -1;
+        }
+        else
+        {
+            tree_rank = mpi_rank - excess;
+        }
+
+        std::vector<int> partners;
+        if (tree_rank >= 0)
+        {
+            int nxt_distance = 1;
+            while (nxt_distance < tree_size)
+            {
+                int temp = int((tree_rank) / nxt_distance);
+                int skip = 0;
+
+                if (temp % 2 == 1)
+                    skip = -nxt_distance;
+                else
+                    skip = nxt_distance;
+
+                int partner_tree_rank = tree_rank + skip;
+                partners.push_back(partner_tree_rank < excess ? 2 * partner_tree_rank : partner_tree_rank + excess);
+
+                nxt_distance *= 2;
+            }
+        }
+
+        // fold in
+        if (tree_rank == -1)
+        {
+            parent_rank = mpi_rank - 1;
+            cag.send(parent_rank, config.wire_format, fold_bytes);
+        }
+        else if (mpi_rank < 2 * excess)
+        {
+            children.emplace_back(mpi_rank + 1, cag.mergeFromChild(mpi_rank + 1, config.wire_format));
+        }
+        profile.lap("fold in");
+
+        // exchange and create. folded ranks only take part in the collective of PRINT_CAG_LEVELS
+        for (int i = 0; (1 << i) < tree_size; ++i)
+        {
+            double level_start_time = MPI_Wtime();
+            double contract_seconds_before = cag.contract_seconds;
+            unsigned long long allocations_before = scratchAllocations();
+            WireBytes wire_bytes;
+            if (tree_rank >= 0)
+            {
+                cag.exchangeAndMerge(partners[i], config.wire_format, config.chunk_bytes, wire_bytes);
+            }
+            unsigned long long allocations = scratchAllocations() - allocations_before;
+            recordCAGLevel(profile, cag, i, MPI_Wtime() - level_start_time, cag.contract_seconds - contract_seconds_before, wire_bytes, allocations);
+
+            if (PRINT_CAG_LEVELS)
+            {
+                printCAGLevel(cag, i, MPI_Wtime() - level_start_time, wire_bytes, allocations, mpi_rank);
+            }
+        }
+    }
+
+    // push the resolved labels back down, the last child got the biggest part of the graph so it is answered first
+    profile.skip();
+    if (parent_rank != -1)
+    {
+        cag.receiveResolvedLabels(parent_rank);
+    }
+    for (size_t c = children.size(); c-- > 0;)
+    {
+        cag.sendResolvedLabels(children[c].first, children[c].second);
+    }
+    profile.lap("label sweep");
+
+    for (size_t i = 0; i < labels.size(); ++i)
+    {
+        labels[i] = cag.find(labels[i]);
+    }
+    profile.lap("relabel");
+
+    return applyBatchesAndWrite(labels, g_sub.startVertexIndex, total_vertices, config, profile, mpi_rank, mpi_size);
+}
+
+/*
+entry point of --labels: instead of reading the graph and reducing its CAGs, every rank reads its vertex balanced part
+of the labels dataset of an earlier --output file, then the batches are added to these components as after run()
+*/
+template <typename VertexId>
+int runFromLabels(int mpi_rank, int mpi_size, const Config &config, Profile &profile)
+{
+    profile.skip();
+    HDF5Reader file(config.labels_path, MPI_COMM_WORLD);
+    hsize_t rows = file.rowCount("labels");
+    if (rows > static_cast<hsize_t>(std::numeric_limits<VertexId>::max()))
+    {
+        throw std::runtime_error("The labels file has too many vertices for VertexId, build with VERTEX_ID_BITS=64");
+    }
+    VertexId total_vertices = rows;
+    std::pair<VertexId, VertexId> my_range = vertexBalancedRange(total_vertices, mpi_rank, mpi_size);
+    std::vector<VertexId> labels(my_range.second - my_range.first + 1);
+    file.readRows("labels", my_range.first, labels.size(), labels.data());
+    for (VertexId label : labels)
+    {
+        if (label < 0 || label >= total_vertices)
+        {
+            throw std::runtime_error("Label " + std::to_string(label) + " of " + config.labels_path + " is out of range");
+        }
+    }
+    profile.lap("read labels");
+
+    return applyBatchesAndWrite(labels, my_range.first, total_vertices, config, profile, mpi_rank, mpi_size);
+}
+
+/*
+parses the command line:
+    --input=<file>               the graph file, HDF5 or the CSR format of convert --format=csr (default: data/coauth-DBLP-full-proj-graph-LIST_REMAP.h5)
+    --partition=vertices|edges   how the vertices are split into contiguous ranges (default: vertices)
+    --border-weight=<w>          with --partition=edges, also weight the expected border edges by w
+    --reduction=butterfly|tree|node
+                                 how the CAGs are reduced (default: butterfly)
+    --ranks-per-node=<k>         with --reduction=node, emulate nodes of k consecutive ranks (default: the real nodes)
+    --wire=raw|varint            encoding of the CAGs sent in the reduction tree (default: raw)
+    --chunk-size=<KiB>           size of the messages the CAG exchange is split into, 0 for a single message (default: 1024)
+    --threads=<n>                threads per rank for the local connected components (default: 1)
+    --output=<file>              write the label of every vertex to the dataset "labels" of an HDF5 file
+    --component-sizes            with --output, also write the (label, size) table "component_sizes"
+    --warmup=<n>, --repeat=<n>   run n untimed warm-up runs, then n timed runs (defaults: 0, 1)
+    --stats=json|csv             print min / median / max over all ranks of every phase and counter of the timed runs
+    --stats-file=<file>          write the --stats output to a file instead of standard output
+    --generate=er|rmat|grid|path|ladder
+                                 generate a synthetic graph on every rank instead of reading the HDF5 file
+    --scale=<s>                  the generated graph has 2^s vertices (default: 20)
+    --edge-factor=<k>            er and rmat draw k * 2^s edges (default: 16)
+    --seed=<x>                   seed of the generated graph (default: 1)
+    --scramble                   permute the vertex ids of the generated graph, so neighbors end up on different ranks
+    --batch=<file>               after the run, add the edges "u v" of file to its components, without a new run. can
+                                 be given more than once, the batches are added in order
+    --labels=<file>              take the components from the labels of an earlier --output file instead of reading the
+                                 graph and running the reduction, e.g. to add --batch files to them
+*/
+Config parseArguments(int argc, char **argv)
+{
+    Config config;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+        if (arg.compare(0, 8, "--input=") == 0)
+        {
+            config.input_path = value;
+        }
+        else if (arg == "--partition=vertices")
+        {
+            config.partition_mode = PARTITION_VERTICES;
+        }
+        else if (arg == "--partition=edges")
+        {
+            config.partition_mode = PARTITION_EDGES;
+        }
+        else if (arg.compare(0, 16, "--border-weight=") == 0)
+        {
+            config.border_weight = std::stod(value);
+        }
+        else if (arg.compare(0, 13, "--chunk-size=") == 0)
+        {
+            config.chunk_bytes = std::stoull(value) * 1024;
+        }
+        else if (arg.compare(0, 10, "--threads=") == 0)
+        {
+            config.threads = std::stoi(value);
+        }
+        else if (arg == "--reduction=butterfly")
+        {
+            config.reduction_mode = REDUCTION_BUTTERFLY;
+        }
+        else if (arg == "--reduction=tree")
+        {
+            config.reduction_mode = REDUCTION_TREE;
+        }
+        else if (arg == "--reduction=node")
+        {
+            config.reduction_mode = REDUCTION_NODE;
+        }
+        else if (arg.compare(0, 17, "--ranks-per-node=") == 0)
+        {
+            config.ranks_per_node = std::stoi(value);
+        }
+        else if (arg.compare(0, 9, "--output=") == 0)
+        {
+            config.output_path = value;
+        }
+        else if (arg == "--component-sizes")
+        {
+            config.component_sizes = true;
+        }
+        else if (arg.compare(0, 9, "--warmup=") == 0)
+        {
+            config.warmup = std::stoi(value);
+        }
+        else if (arg.compare(0, 9, "--repeat=") == 0)
+        {
+            config.repeat = std::stoi(value);
+        }
+        else if (arg == "--stats=json")
+        {
+            config.stats_format = STATS_JSON;
+        }
+        else if (arg == "--stats=csv")
+        {
+            config.stats_format = STATS_CSV;
+        }
+        else if (arg.compare(0, 13, "--stats-file=") == 0)
+        {
+            config.stats_path = value;
+        }
+        else if (arg.compare(0, 11, "--generate=") == 0)
+        {
+            if (value == "er")
+            {
+                config.generator = GENERATE_ER;
+            }
+            else if (value == "rmat")
+            {
+                config.generator = GENERATE_RMAT;
+            }
+            else if (value == "grid")
+            {
+                config.generator = GENERATE_GRID;
+            }
+            else if (value == "path")
+            {
+                config.generator = GENERATE_PATH;
+            }
+            else if (value == "ladder")
+            {
+                config.generator = GENERATE_LADDER;
+            }
+            else
+            {
+                throw std::runtime_error("Unknown generator: " + value);
+            }
+        }
+        else if (arg.compare(0, 8, "--scale=") == 0)
+        {
+            config.scale = std::stoi(value);
+        }
+        else if (arg.compare(0, 14, "--edge-factor=") == 0)
+        {
+            config.edge_factor = std::stoi(value);
+        }
+        else if (arg.compare(0, 7, "--seed=") == 0)
+        {
+            config.seed = std::stoull(value);
+        }
+        else if (arg == "--scramble")
+        {
+            config.scramble = true;
+        }
+        else if (arg.compare(0, 8, "--batch=") == 0)
+        {
+            config.batch_paths.push_back(value);
+        }
+        else if (arg.compare(0, 9, "--labels=") == 0)
+        {
+            config.labels_path = value;
+        }
+        else if (arg == "--wire=raw")
+        {
+            config.wire_format = WIRE_RAW;
+        }
+        else if (arg == "--wire=varint")
+        {
+            config.wire_format = WIRE_VARINT;
+        }
+        else
+        {
+            throw std::runtime_error("Unknown argument: " + arg);
+        }
+    }
+    if (config.generator != GENERATE_NONE && config.partition_mode == PARTITION_EDGES)
+    {
+        throw std::runtime_error("--partition=edges needs the HDF5 file, generated graphs are split by vertices");
+    }
+    if (!config.labels_path.empty() && config.generator != GENERATE_NONE)
+    {
+        throw std::runtime_error("--labels replaces the graph, it cannot be combined with --generate");
+    }
+    return config;
+}
+
+int main(int argc, char **argv)
+{
+    // only the main thread calls MPI, the local connected components may run on more threads
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+    int mpi_rank;
+    int mpi_size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    Config config = parseArguments(argc, argv);
+    double commulative_time = 0;
+    int runs = 0;
+    std::vector<std::vector<Profile::Summary>> profiles;
+    for (int i = 0; i < config.warmup + config.repeat; ++i)
+    {
+        bool warmup = i < config.warmup;
+        Profile profile;
+        double start_time = MPI_Wtime();
+
+        if (config.labels_path.empty())
+        {
+            run<GraphVertexId, GraphEdgeOffset>(mpi_rank, mpi_size, config, profile);
+        }
+        else
+        {
+            runFromLabels<GraphVertexId>(mpi_rank, mpi_size, config, profile);
+        }
+
+        double end_time = MPI_Wtime();
+        profile.record("total", "s", end_time - start_time);
+        if (!warmup)
+        {
+            runs++;
+            commulative_time += end_time - start_time;
+            if (config.stats_format != STATS_NONE)
+            {
+                profiles.push_back(profile.aggregate(mpi_rank, mpi_size));
+            }
+        }
+        if (mpi_rank == 0)
+        {
+            std::cout << "time taken: " << end_time - start_time;
+            if (warmup)
+            {
+                std::cout << " (warm-up)";
+            }
+            else
+            {
+                std::cout << ", average time: " << commulative_time / runs;
+            }
+            std::cout << std::endl
+                      << std::endl;
+        }
+    }
+
+    if (config.stats_format != STATS_NONE && mpi_rank == 0)
+    {
+        if (config.stats_path.empty())
+        {
+            writeProfiles(std::cout, config.stats_format, profiles, mpi_size);
+        }
+        else
+        {
+            std::ofstream out(config.stats_path);
+            writeProfiles(out, config.stats_format, profiles, mpi_size);
+        }
+    }
 
     MPI_Finalize();
     return 0;
@@ -0,0 +1,276 @@
+/*
+Serial reference for the connected components computed by main.cpp. It streams the data dataset of an HDF5 graph in
+blocks, unions every vertex with its neighbors in a union-find and prints the number of components. Given the output
+file of "main --output=<file>", it also checks the labels against its own components:
+
+    - the file holds one label per vertex
+    - every label is a vertex id, i.e. lies in [0, vertices)
+    - two vertices have the same label exactly if they are in the same component
+    - if the file holds component_sizes, it has one row per component with the right size
+
+usage: reference <graph.h5> [<labels.h5>]
+prints "components <n>" and, with a labels file, "check ok" or "check FAILED: <reason>" (exit code 2)
+*/
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <chrono>
+#include <hdf5.h>
+
+static void check(long long status, const std::string &what)
+{
+    if (status < 0)
+    {
+        throw std::runtime_error("HDF5 error: " + what);
+    }
+}
+
+/// @brief reads a dataset of integers (int32 or int64) in blocks of rows, converted to long long
+class DatasetReader
+{
+private:
+    hid_t dataset;
+    hid_t space;
+    std::vector<hsize_t> dims;
+
+public:
+    DatasetReader(hid_t file, const char *name)
+    {
+        dataset = H5Dopen(file, name, H5P_DEFAULT);
+        check(dataset, std::string("could not open dataset ") + name);
+        space = H5Dget_space(dataset);
+        dims.resize(H5Sget_simple_extent_ndims(space));
+        H5Sget_simple_extent_dims(space, dims.data(), NULL);
+    }
+
+    ~DatasetReader()
+    {
+        H5Sclose(space);
+        H5Dclose(dataset);
+    }
+
+    DatasetReader(const DatasetReader &) = delete;
+    DatasetReader &operator=(const DatasetReader &) = delete;
+
+    hsize_t rows() const
+    {
+        return dims.empty() ? 1 : dims[0];
+    }
+
+    hsize_t columns() const
+    {
+        return dims.size() < 2 ? 1 : dims[1];
+    }
+
+    /*reads the rows [first, first + count) into block (count * columns() values)*/
+    void read(hsize_t first, hsize_t count, std::vector<long long> &block) const
+    {
+        block.resize(count * columns());
+        if (dims.empty())
+        {
+            check(H5Dread(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, block.data()), "could not read scalar");
+            return;
+        }
+        std::vector<hsize_t> offset(dims.size(), 0);
+        std::vector<hsize_t> size(dims);
+        offset[0] = first;
+        size[0] = count;
+        hid_t memspace = H5Screate_simple(dims.size(), size.data(), NULL);
+        H5Sselect_hyperslab(space, H5S_SELECT_SET, offset.data(), NULL, size.data(), NULL);
+        herr_t status = H5Dread(dataset, H5T_NATIVE_LLONG, memspace, space, H5P_DEFAULT, block.data());
+        H5Sclose(memspace);
+        check(status, "could not read block");
+    }
+};
+
+/// @brief union-find with path halving, the smaller id becomes the root
+class UnionFind
+{
+private:
+    std::vector<long long> parent;
+
+public:
+    UnionFind(long long size) : parent(size)
+    {
+        for (long long i = 0; i < size; ++i)
+        {
+            parent[i] = i;
+        }
+    }
+
+    long long find(long long x)
+    {
+        while (parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void unite(long long a, long long b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a < b)
+        {
+            parent[b] = a;
+        }
+        else if (b < a)
+        {
+            parent[a] = b;
+        }
+    }
+};
+
+/*returns an empty string if the labels of labels_path describe the components of uf, the first difference otherwise*/
+std::string checkLabels(const std::string &labels_path, UnionFind &uf, long long vertices, long long components)
+{
+    hid_t file = H5Fopen(labels_path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    check(file, "could not open " + labels_path);
+    std::string failure;
+    {
+        DatasetReader reader(file, "labels");
+        if (static_cast<long long>(reader.rows()) != vertices)
+        {
+            failure = "labels has " + std::to_string(reader.rows()) + " rows, expected " + std::to_string(vertices);
+        }
+
+        // the label of every root and the root of every label, both have to be unique
+        std::vector<long long> root_label(vertices, -1);
+        std::vector<long long> label_root(vertices, -1);
+        std::vector<long long> labels;
+        const hsize_t block_rows = 1 << 22;
+        for (hsize_t first = 0; failure.empty() && first < reader.rows(); first += block_rows)
+        {
+            reader.read(first, std::min(block_rows, reader.rows() - first), labels);
+            for (size_t i = 0; i < labels.size(); ++i)
+            {
+                long long v = first + i;
+                long long label = labels[i];
+                long long root = uf.find(v);
+                if (label < 0 || label >= vertices)
+                {
+                    failure = "vertex " + std::to_string(v) + " has label " + std::to_string(label) + ", which is not a vertex id";
+                    break;
+                }
+                if (root_label[root] == -1 && label_root[label] == -1)
+                {
+                    root_label[root] = label;
+                    label_root[label] = root;
+                }
+                if (root_label[root] == -1)
+                {
+                    failure = "vertex " + std::to_string(v) + " has label " + std::to_string(label) + ", which is also used by another component";
+                    break;
+                }
+                if (root_label[root] != label)
+                {
+                    failure = "vertex " + std::to_string(v) + " has label " + std::to_string(label) + ", another vertex of its component " + std::to_string(root_label[root]);
+                    break;
+                }
+            }
+        }
+
+        if (failure.empty() && H5Lexists(file, "component_sizes", H5P_DEFAULT) > 0)
+        {
+            DatasetReader sizes(file, "component_sizes");
+            std::vector<long long> table;
+            sizes.read(0, sizes.rows(), table);
+            std::vector<long long> expected(vertices, 0);
+            for (long long v = 0; v < vertices; ++v)
+            {
+                expected[uf.find(v)]++;
+            }
+            if (static_cast<long long>(sizes.rows()) != components)
+            {
+                failure = "component_sizes has " + std::to_string(sizes.rows()) + " rows, expected " + std::to_string(components);
+            }
+            for (size_t i = 0; failure.empty() && i + 1 < table.size(); i += 2)
+            {
+                long long label = table[i];
+                if (label < 0 || label >= vertices || label_root[label] == -1 || expected[label_root[label]] != table[i + 1])
+                {
+                    failure = "wrong size " + std::to_string(table[i + 1]) + " for the component of label " + std::to_string(label);
+                }
+            }
+        }
+    }
+    H5Fclose(file);
+    return failure;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <graph.h5> [<labels.h5>]" << std::endl;
+        return 1;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    hid_t file = H5Fopen(argv[1], H5F_ACC_RDONLY, H5P_DEFAULT);
+    check(file, std::string("could not open ") + argv[1]);
+
+    long long vertices;
+    std::vector<long long> block;
+    {
+        DatasetReader reader(file, "vertices");
+        reader.read(0, 1, block);
+        vertices = block[0];
+    }
+
+    // data holds "vertex neighbor... -1" per vertex, so the current vertex is the first value after every -1
+    UnionFind uf(vertices);
+    {
+        DatasetReader reader(file, "data");
+        const hsize_t block_rows = 1 << 24;
+        long long vertex = -1;
+        for (hsize_t first = 0; first < reader.rows(); first += block_rows)
+        {
+            reader.read(first, std::min(block_rows, reader.rows() - first), block);
+            for (long long value : block)
+            {
+                if (value == -1)
+                {
+                    vertex = -1;
+                }
+                else if (vertex == -1)
+                {
+                    vertex = value;
+                }
+                else
+                {
+                    uf.unite(vertex, value);
+                }
+            }
+        }
+    }
+    H5Fclose(file);
+
+    long long components = 0;
+    for (long long v = 0; v < vertices; ++v)
+    {
+        if (uf.find(v) == v)
+        {
+            components++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "components " << components << std::endl;
+    std::cout << "reference time " << seconds << std::endl;
+
+    if (argc == 3)
+    {
+        std::string failure = checkLabels(argv[2], uf, vertices, components);
+        if (!failure.empty())
+        {
+            std::cout << "check FAILED: " << failure << std::endl;
+            return 2;
+        }
+        std::cout << "check ok" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,414 @@
+/*
+Preprocessing stage that renumbers the vertices of an HDF5 list graph (as written by convert) so that the contiguous id
+ranges main.cpp hands to the ranks cut few edges. The CAG only holds components with an edge leaving the ranges that
+were merged so far, so fewer cut edges mean smaller CAGs on every level of the reduction tree.
+
+The order is Cuthill-McKee per connected component: a component gets a contiguous block of new ids, numbered in BFS
+order from a vertex of minimum degree, with the neighbors of a vertex numbered by increasing degree. Components that fit
+into one range are not cut at all, and a component that spans ranges is cut roughly where its BFS frontier is.
+
+For every amount of ranks of --ranks (vertex balanced ranges, as --partition=vertices) it reports, for the original and
+the new order, the fraction of cut edges and, for the fold-in and every level of the butterfly reduction, the amount of
+edges leaving the merged groups of ranks and the components of these groups that have such an edge. this is an estimate
+of the CAG nodes sent on that level from the cut edges; main --stats measures the real CAG sizes.
+
+The output has the datasets of the input (data, lookup, vertices) in the new order, and "original_ids" with the old id
+of every new vertex, to map labels written by "main --output" back.
+
+usage: reorder <input.h5> <output.h5> [--ranks=<p>,<p>,...]
+*/
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <climits>
+#include <stdexcept>
+#include <hdf5.h>
+
+static void check(long long status, const std::string &what)
+{
+    if (status < 0)
+    {
+        throw std::runtime_error("HDF5 error: " + what);
+    }
+}
+
+/// @brief undirected graph in CSR form
+struct Graph
+{
+    long long vertices = 0;
+    std::vector<long long> offsets;
+    std::vector<long long> targets;
+
+    long long degree(long long v) const
+    {
+        return offsets[v + 1] - offsets[v];
+    }
+};
+
+/*reads a one dimensional integer dataset, or a scalar, converted to long long*/
+std::vector<long long> readDataset(hid_t file, const char *name)
+{
+    hid_t dataset = H5Dopen(file, name, H5P_DEFAULT);
+    check(dataset, std::string("could not open dataset ") + name);
+    hid_t space = H5Dget_space(dataset);
+    hsize_t size = H5Sget_simple_extent_npoints(space);
+    std::vector<long long> values(size);
+    herr_t status = H5Dread(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+    H5Sclose(space);
+    H5Dclose(dataset);
+    check(status, std::string("could not read dataset ") + name);
+    return values;
+}
+
+/*the data dataset holds "vertex neighbor... -1" per vertex*/
+Graph readGraph(const std::string &path)
+{
+    hid_t file = H5Fopen(path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    check(file, "could not open " + path);
+    Graph g;
+    g.vertices = readDataset(file, "vertices")[0];
+    std::vector<long long> data = readDataset(file, "data");
+    H5Fclose(file);
+
+    g.offsets.assign(g.vertices + 1, 0);
+    g.targets.reserve(data.size() - 2 * g.vertices);
+    long long vertex = -1;
+    long long lines = 0;
+    for (long long value : data)
+    {
+        if (value == -1)
+        {
+            vertex = -1;
+        }
+        else if (vertex == -1)
+        {
+            vertex = value;
+            if (vertex != lines++)
+            {
+                throw std::runtime_error("line " + std::to_string(lines - 1) + " belongs to vertex " + std::to_string(vertex));
+            }
+        }
+        else
+        {
+            g.targets.push_back(value);
+            g.offsets[vertex + 1]++;
+        }
+    }
+    for (long long v = 0; v < g.vertices; ++v)
+    {
+        g.offsets[v + 1] += g.offsets[v];
+    }
+    return g;
+}
+
+/*returns the new id of every vertex*/
+std::vector<long long> cuthillMcKee(const Graph &g)
+{
+    std::vector<long long> new_id(g.vertices, -1);
+    std::vector<long long> queue;
+    std::vector<long long> component;
+    std::vector<char> seen(g.vertices, 0);
+    long long next_id = 0;
+
+    for (long long first = 0; first < g.vertices; ++first)
+    {
+        if (seen[first])
+        {
+            continue;
+        }
+
+        // find the component, then start from a vertex of minimum degree (a cheap stand-in for a peripheral vertex)
+        component.assign(1, first);
+        seen[first] = 1;
+        long long start = first;
+        for (size_t i = 0; i < component.size(); ++i)
+        {
+            long long v = component[i];
+            if (g.degree(v) < g.degree(start))
+            {
+                start = v;
+            }
+            for (long long e = g.offsets[v]; e < g.offsets[v + 1]; ++e)
+            {
+                if (!seen[g.targets[e]])
+                {
+                    seen[g.targets[e]] = 1;
+                    component.push_back(g.targets[e]);
+                }
+            }
+        }
+
+        queue.assign(1, start);
+        new_id[start] = next_id++;
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            long long v = queue[head];
+            size_t first_new = queue.size();
+            for (long long e = g.offsets[v]; e < g.offsets[v + 1]; ++e)
+            {
+                long long w = g.targets[e];
+                if (new_id[w] == -1)
+                {
+                    new_id[w] = -2; // queued
+                    queue.push_back(w);
+                }
+            }
+            std::sort(queue.begin() + first_new, queue.end(), [&g](long long a, long long b)
+                      { return g.degree(a) < g.degree(b) || (g.degree(a) == g.degree(b) && a < b); });
+            for (size_t i = first_new; i < queue.size(); ++i)
+            {
+                new_id[queue[i]] = next_id++;
+            }
+        }
+    }
+    return new_id;
+}
+
+/*rank of vertex v with vertex balanced ranges, as vertexBalancedRange() in main.cpp*/
+int rankOf(long long v, long long vertices, int ranks)
+{
+    long long per_rank = vertices / ranks;
+    return static_cast<int>(std::min<long long>(v / per_rank, ranks - 1));
+}
+
+/// @brief union-find for the components of the groups of ranks
+class UnionFind
+{
+private:
+    std::vector<long long> parent;
+
+public:
+    UnionFind(long long size) : parent(size)
+    {
+        for (long long i = 0; i < size; ++i)
+        {
+            parent[i] = i;
+        }
+    }
+
+    long long find(long long x)
+    {
+        while (parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void unite(long long a, long long b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a != b)
+        {
+            parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+};
+
+/*
+edges leaving the groups of ranks (group[r] is the group of rank r) and the components of the groups with such an edge,
+which is what the CAGs of these groups hold
+*/
+void countCut(const Graph &g, const std::vector<long long> &id, int ranks, const std::vector<int> &group, long long &cut, long long &border_components)
+{
+    UnionFind uf(g.vertices);
+    cut = 0;
+    for (long long v = 0; v < g.vertices; ++v)
+    {
+        int own = group[rankOf(id[v], g.vertices, ranks)];
+        for (long long e = g.offsets[v]; e < g.offsets[v + 1]; ++e)
+        {
+            long long w = g.targets[e];
+            if (group[rankOf(id[w], g.vertices, ranks)] == own)
+            {
+                uf.unite(v, w);
+            }
+            else
+            {
+                cut++;
+            }
+        }
+    }
+    cut /= 2;
+
+    std::vector<char> border(g.vertices, 0);
+    border_components = 0;
+    for (long long v = 0; v < g.vertices; ++v)
+    {
+        int own = group[rankOf(id[v], g.vertices, ranks)];
+        for (long long e = g.offsets[v]; e < g.offsets[v + 1]; ++e)
+        {
+            if (group[rankOf(id[g.targets[e]], g.vertices, ranks)] != own)
+            {
+                long long root = uf.find(v);
+                border_components += border[root] ? 0 : 1;
+                border[root] = 1;
+                break;
+            }
+        }
+    }
+}
+
+/*
+prints the cut of the order id (id[v] is the position of vertex v) for ranks ranks: the cut edge fraction, and for every
+step of the butterfly reduction of main.cpp the edges leaving the groups of ranks and the components of the groups with
+such an edge. like run(), the ranks over the largest power of two tree_size <= ranks are first folded into their left
+neighbor (the first 2 * excess ranks pair up), then level l merges blocks of 2^l tree ranks. this estimates the CAG sizes
+from the cut edges, the real ones are in the --stats output of main.
+*/
+void reportCut(const Graph &g, const std::vector<long long> &id, int ranks, const std::string &order)
+{
+    long long edges = g.targets.size() / 2;
+    int tree_size = 1;
+    while (tree_size * 2 <= ranks)
+    {
+        tree_size *= 2;
+    }
+    int excess = ranks - tree_size;
+    std::vector<int> tree_rank(ranks);
+    for (int rank = 0; rank < ranks; ++rank)
+    {
+        tree_rank[rank] = rank < 2 * excess ? rank / 2 : rank - excess;
+    }
+
+    std::vector<int> group(ranks);
+    long long cut;
+    long long border_components;
+    for (int rank = 0; rank < ranks; ++rank)
+    {
+        group[rank] = rank;
+    }
+    countCut(g, id, ranks, group, cut, border_components);
+    std::cout << order << ", " << ranks << " ranks: " << cut << " of " << edges << " edges cut ("
+              << (edges > 0 ? 100.0 * cut / edges : 0) << " %), estimated from the cut edges:" << std::endl;
+    if (excess > 0)
+    {
+        std::cout << "    fold in: " << excess << " of " << ranks << " ranks send, components with a cut edge: "
+                  << border_components << " over all ranks" << std::endl;
+    }
+
+    for (int level = 0; (1 << level) < tree_size; ++level)
+    {
+        for (int rank = 0; rank < ranks; ++rank)
+        {
+            group[rank] = tree_rank[rank] >> level;
+        }
+        countCut(g, id, ranks, group, cut, border_components);
+        std::cout << "    level " << level << ": " << cut << " edges leave the groups of " << (1 << level)
+                  << " tree ranks, components with a cut edge: " << border_components << std::endl;
+    }
+}
+
+/*int32 if every value fits, int64 otherwise, like the converter*/
+void writeDataset(hid_t file, const char *name, int rank, const hsize_t *dims, const std::vector<long long> &values, long long max_value)
+{
+    hid_t type = max_value > INT_MAX ? H5T_STD_I64LE : H5T_STD_I32LE;
+    hid_t space = rank == 0 ? H5Screate(H5S_SCALAR) : H5Screate_simple(rank, dims, NULL);
+    hid_t dataset = H5Dcreate(file, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5Sclose(space);
+    check(dataset, std::string("could not create dataset ") + name);
+    herr_t status = H5Dwrite(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+    H5Dclose(dataset);
+    check(status, std::string("could not write dataset ") + name);
+}
+
+void writeGraph(const std::string &path, const Graph &g, const std::vector<long long> &new_id)
+{
+    std::vector<long long> old_id(g.vertices);
+    for (long long v = 0; v < g.vertices; ++v)
+    {
+        old_id[new_id[v]] = v;
+    }
+
+    std::vector<long long> data;
+    std::vector<long long> lookup;
+    data.reserve(g.targets.size() + 2 * g.vertices);
+    lookup.reserve(2 * g.vertices);
+    for (long long n = 0; n < g.vertices; ++n)
+    {
+        long long v = old_id[n];
+        lookup.push_back(data.size());
+        data.push_back(n);
+        size_t first = data.size();
+        for (long long e = g.offsets[v]; e < g.offsets[v + 1]; ++e)
+        {
+            data.push_back(new_id[g.targets[e]]);
+        }
+        std::sort(data.begin() + first, data.end());
+        lookup.push_back(data.size());
+        data.push_back(-1);
+    }
+
+    hid_t file = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    check(file, "could not create " + path);
+    hsize_t data_dims[1] = {data.size()};
+    hsize_t lookup_dims[2] = {static_cast<hsize_t>(g.vertices), 2};
+    hsize_t vertex_dims[1] = {static_cast<hsize_t>(g.vertices)};
+    writeDataset(file, "data", 1, data_dims, data, g.vertices);
+    writeDataset(file, "lookup", 2, lookup_dims, lookup, data.size());
+    writeDataset(file, "original_ids", 1, vertex_dims, old_id, g.vertices);
+    std::vector<long long> vertices(1, g.vertices);
+    hid_t scalar = H5Screate(H5S_SCALAR);
+    hid_t dataset = H5Dcreate(file, "vertices", H5T_STD_I64LE, scalar, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5Sclose(scalar);
+    check(dataset, "could not create dataset vertices");
+    check(H5Dwrite(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, vertices.data()), "could not write vertices");
+    H5Dclose(dataset);
+    H5Fclose(file);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <input.h5> <output.h5> [--ranks=<p>,<p>,...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<int> rank_counts = {2, 4, 8, 16, 32, 64};
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 8, "--ranks=") == 0)
+        {
+            rank_counts.clear();
+            for (size_t begin = 8; begin < arg.size();)
+            {
+                size_t end = arg.find(',', begin);
+                end = end == std::string::npos ? arg.size() : end;
+                rank_counts.push_back(std::stoi(arg.substr(begin, end - begin)));
+                begin = end + 1;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    Graph g = readGraph(argv[1]);
+    std::vector<long long> original_order(g.vertices);
+    for (long long v = 0; v < g.vertices; ++v)
+    {
+        original_order[v] = v;
+    }
+    std::vector<long long> new_id = cuthillMcKee(g);
+
+    for (int ranks : rank_counts)
+    {
+        if (ranks < 2 || ranks > g.vertices)
+        {
+            continue;
+        }
+        reportCut(g, original_order, ranks, "original order");
+        reportCut(g, new_id, ranks, "Cuthill-McKee order");
+    }
+
+    writeGraph(argv[2], g, new_id);
+    std::cout << "written " << argv[2] << std::endl;
+    return 0;
+}
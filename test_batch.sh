@@ -0,0 +1,47 @@
+#!/bin/bash
+# Test of --labels with --batch, run by "make test-batch". Builds a small graph and two edge batches, writes the labels
+# of the graph with main, adds the batches to the saved labels with --labels and checks the result with ./reference
+# against the graph that holds the batch edges from the start.
+#
+# configuration (environment variables):
+#   TEST_RANKS     rank counts (default: 1 2 3 4)
+#   MPIEXEC        launcher (default: mpiexec --oversubscribe --allow-run-as-root)
+#
+# the exit code is 1 if any run did not match the reference.
+
+RANKS=${TEST_RANKS:-1 2 3 4}
+MPIEXEC=${MPIEXEC:-mpiexec --oversubscribe --allow-run-as-root}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# 4000 vertices in paths of 10, so every vertex has an edge and the converter keeps the ids. the batches join random
+# pairs of vertices, a few of them twice or inside one path
+awk 'BEGIN { for (v = 0; v < 4000; ++v) if ((v + 1) % 10 != 0) print v, v + 1, 0 }' >"$WORK/graph.txt"
+awk -v seed=1 'BEGIN { srand(seed); for (i = 0; i < 150; ++i) print int(rand() * 4000), int(rand() * 4000) }' >"$WORK/batch0.txt"
+awk -v seed=2 'BEGIN { srand(seed); for (i = 0; i < 150; ++i) print int(rand() * 4000), int(rand() * 4000) }' >"$WORK/batch1.txt"
+cat "$WORK/graph.txt" >"$WORK/combined.txt"
+awk '{ print $1, $2, 0 }' "$WORK/batch0.txt" "$WORK/batch1.txt" >>"$WORK/combined.txt"
+
+./convert "$WORK/graph.txt" "$WORK/graph.h5" --tmp="$WORK" >/dev/null || exit 1
+./convert "$WORK/combined.txt" "$WORK/combined.h5" --tmp="$WORK" >/dev/null || exit 1
+
+failures=0
+for ranks in $RANKS; do
+    rm -f "$WORK/saved.h5" "$WORK/labels.h5"
+    $MPIEXEC -n "$ranks" ./main --input="$WORK/graph.h5" --output="$WORK/saved.h5" >/dev/null 2>&1
+    run_output=$($MPIEXEC -n "$ranks" ./main --labels="$WORK/saved.h5" --batch="$WORK/batch0.txt" --batch="$WORK/batch1.txt" \
+        --output="$WORK/labels.h5" --component-sizes 2>&1)
+    if check_output=$(./reference "$WORK/combined.h5" "$WORK/labels.h5" 2>&1); then
+        echo "$ranks ranks: ok"
+    else
+        failures=$((failures + 1))
+        echo "$ranks ranks: $(echo "$check_output" | tail -n 1)" >&2
+        echo "$run_output" | grep -i error >&2
+    fi
+done
+
+if [ $failures -gt 0 ]; then
+    echo "$failures runs did not match the reference" >&2
+    exit 1
+fi